@@ -0,0 +1,104 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class BlockRMQ
+ */
+#include "BlockRMQ.hpp"
+#include "SimdKernels.hpp"
+
+namespace supbub{
+
+  /* floor(log2(x)) for x >= 1 */
+  static inline int64_t
+  floorLog2(int64_t x){
+    return 63 - __builtin_clzll((unsigned long long)x);
+  }
+
+  BlockRMQ::BlockRMQ(const int64_t* values, int64_t n, bool isMin) {
+    _values = values;
+    _n = n;
+    _isMin = isMin;
+    _numBlocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    _numLevels = (_numBlocks > 0) ? floorLog2(_numBlocks) + 1 : 0;
+    _table = new int64_t*[_numLevels];
+
+    if (_numLevels == 0) {
+      return;
+    }
+    // level 0: minimum of each block
+    _table[0] = new int64_t[_numBlocks];
+    for (int64_t b = 0; b < _numBlocks; ++b) {
+      int64_t first = b * BLOCK_SIZE;
+      int64_t len = std::min(BLOCK_SIZE, _n - first);
+      _table[0][b] = scan(_values + first, len);
+    }
+
+    // level k from level k-1: element-wise minimum of the level and itself shifted by 2^(k-1)
+    for (int64_t k = 1; k < _numLevels; ++k) {
+      int64_t half = int64_t(1) << (k - 1);
+      int64_t len = _numBlocks - (int64_t(1) << k) + 1;
+      _table[k] = new int64_t[len];
+      if (_isMin) {
+	pairwiseMin(_table[k-1], _table[k-1] + half, _table[k], len);
+      } else {
+	pairwiseMax(_table[k-1], _table[k-1] + half, _table[k], len);
+      }
+    }
+  }
+
+  BlockRMQ::~BlockRMQ() {
+    for (int64_t k = 0; k < _numLevels; ++k) {
+      delete[] _table[k];
+    }
+    delete[] _table;
+  }
+
+  int64_t
+  BlockRMQ::query(int64_t l, int64_t r){
+    int64_t bl = l / BLOCK_SIZE;
+    int64_t br = r / BLOCK_SIZE;
+    if (bl == br) { // within one block
+      return scan(_values + l, r - l + 1);
+    }
+    // partial blocks at both ends
+    int64_t res = better(scan(_values + l, (bl + 1) * BLOCK_SIZE - l),
+			 scan(_values + br * BLOCK_SIZE, r - br * BLOCK_SIZE + 1));
+    // full blocks in between
+    if (br - bl > 1) {
+      int64_t first = bl + 1;
+      int64_t last = br - 1;
+      int64_t k = floorLog2(last - first + 1);
+      res = better(res, better(_table[k][first], _table[k][last - (int64_t(1) << k) + 1]));
+    }
+    return res;
+  }
+
+  int64_t
+  BlockRMQ::sizeInBytes(){
+    int64_t bytes = _numLevels * sizeof(int64_t*);
+    for (int64_t k = 0; k < _numLevels; ++k) {
+      bytes += (_numBlocks - (int64_t(1) << k) + 1) * sizeof(int64_t);
+    }
+    return bytes;
+  }
+
+  //////////////////////// private ////////////////////////
+
+  int64_t
+  BlockRMQ::scan(const int64_t* a, int64_t len){
+    return _isMin ? arrayMin(a, len) : arrayMax(a, len);
+  }
+
+} // end namespace
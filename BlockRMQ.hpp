@@ -0,0 +1,92 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class BlockRMQ.
+ * It answers range minimum (or maximum) queries on an array using a sparse table over blocks.
+ */
+
+#ifndef BLOCK_RMQ_HPP
+#define BLOCK_RMQ_HPP
+
+#include "globalDefs.hpp"
+
+namespace supbub{
+
+  /** Class BlockRMQ
+   * The array is cut into blocks of BLOCK_SIZE elements:
+   *   - A sparse table is built over the minima(/maxima) of the blocks: level k holds, for each block b, the minimum over blocks b ... b+2^k-1.
+   *   - A query is answered by scanning the (at most two) partial blocks at the ends of the range and a lookup of two entries of the sparse table for the blocks in between.
+   * Both the building of a level and the scan of a partial block are data-parallel and use the SIMD kernels.
+   * It is an alternative to the succinct rmq of sdsl: it takes more space (about 2n/BLOCK_SIZE log(n/BLOCK_SIZE) words) but answers queries faster.
+   *
+   * The array is not copied. It must stay alive (and unchanged) as long as this object is used.
+   */
+
+  class BlockRMQ{
+
+  public:
+
+    /** number of elements in a block */
+    static const int64_t BLOCK_SIZE = 64;
+
+    /** Constructor
+     * @param values pointer to the array on which queries are to be answered.
+     * @param n number of elements of the array.
+     * @param isMin true for range minimum queries, false for range maximum queries.
+     */
+    BlockRMQ(const int64_t* values, int64_t n, bool isMin);
+
+    /** Destructor */
+    ~BlockRMQ();
+
+    /** Returns the minimum (or maximum) of the values in [l, r].
+     * Assumes 0 <= l <= r < n.
+     */
+    int64_t query(int64_t l, int64_t r);
+
+    /** Gives the number of bytes of the sparse table (the array is not counted). */
+    int64_t sizeInBytes();
+
+  private:
+
+    /** array on which queries are answered */
+    const int64_t* _values;
+
+    /** number of elements of the array */
+    int64_t _n;
+
+    /** true for minimum, false for maximum */
+    bool _isMin;
+
+    /** number of blocks */
+    int64_t _numBlocks;
+
+    /** number of levels of the sparse table */
+    int64_t _numLevels;
+
+    /** sparse table over the blocks
+     * _table[k][b] = minimum(/maximum) of the values in blocks b ... b+2^k-1
+     */
+    int64_t** _table;
+
+    /** Returns the minimum (or maximum) of the two values. */
+    int64_t better(int64_t a, int64_t b) { return _isMin ? std::min(a, b) : std::max(a, b); }
+
+    /** Returns the minimum (or maximum) of len consecutive values starting at a. */
+    int64_t scan(const int64_t* a, int64_t len);
+  };
+
+} // end namespace
+#endif
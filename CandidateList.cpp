@@ -22,17 +22,21 @@ namespace supbub{
   CandidateList::CandidateList(){
     _front = nullptr;
     _tail = nullptr;
+    _size = 0;
+    _trackedBytes = 0;
   }
 
   CandidateList::~CandidateList(){
     while (!empty()) {
       delete_tail();
     }
+    updateTrackedMemory();
   }
 
   Candidate* 
   CandidateList::insert(int64_t ver, bool isEntrance, Candidate* pvsEntrance){
     Candidate* newCand = new Candidate{ver, isEntrance, pvsEntrance, nullptr, _tail};
+    _size++;
 
     // if it's not the first node, set tail to it
     if ( _tail != nullptr) {
@@ -64,6 +68,7 @@ namespace supbub{
   void
   CandidateList::delete_tail(){
     if (_tail != nullptr) {
+      _size--;
       if (_front == _tail) {  // last element in the list
 	delete _tail;
 	_front = nullptr;
@@ -77,6 +82,35 @@ namespace supbub{
       }
     }
   }
-   
+
+  void
+  CandidateList::splitBefore(Candidate* first, CandidateList& rest){
+    int64_t moved = 0;
+    for (Candidate* c = first; c != nullptr; c = c->next) {
+      ++moved;
+    }
+    rest._front = first;
+    rest._tail = _tail;
+    rest._size = moved;
+    _size -= moved;
+    _tail = first->pvs;
+    if (_tail != nullptr) {
+      _tail->next = nullptr;
+    }
+    else {
+      _front = nullptr;
+    }
+    first->pvs = nullptr;
+    // the memory accounted so far goes with the candidates
+    rest._trackedBytes = std::min(_trackedBytes, int64_t(moved * sizeof(Candidate)));
+    _trackedBytes -= rest._trackedBytes;
+  }
+
+  void
+  CandidateList::updateTrackedMemory(){
+    int64_t bytes = _size * sizeof(Candidate);
+    memoryChanged(MEM_CANDIDATES, bytes - _trackedBytes);
+    _trackedBytes = bytes;
+  }
 
 }// end namespace
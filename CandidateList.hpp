@@ -20,6 +20,7 @@
 #define CANDIDATELIST_HPP
 
 #include "globalDefs.hpp"
+#include "MemoryStats.hpp"
 
 namespace supbub{
 
@@ -42,6 +43,7 @@ struct Candidate{
    * This class provides for the following:
    *  - Inserting in the list (at the tail).
    *  - Deleting the candidate at the tail.
+   *  - Splitting the list in two.
    *  - Checking if the list is empty.
    *  - Returning a pointer to the candidate at the head of the list.
    *  - Returning a pointer to the candidate at the tail of the list.
@@ -76,6 +78,17 @@ struct Candidate{
     /** Delets the element at the tail. */
     void delete_tail();
 
+    /** Moves the candidates from the given one to the tail to the end of another list.
+     * @param first pointer to a candidate of this list (the new tail is its previous candidate).
+     * @param rest reference to the list receiving the candidates (empty).
+     */
+    void splitBefore(Candidate* first, CandidateList& rest);
+
+    /** Accounts the memory of the candidates currently in the list (see MemoryStats.hpp).
+     * Not done by insert() and delete_tail() themselves, to keep them cheap: it is to be called after a batch of them.
+     */
+    void updateTrackedMemory();
+
   private:
 
     /** pointer to the candidate at the head of the list */
@@ -84,6 +97,12 @@ struct Candidate{
    /** pointer to the candidate at the tail of the list */
     Candidate* _tail;
 
+    /** number of candidates in the list */
+    int64_t _size;
+
+    /** number of bytes of the candidates accounted so far */
+    int64_t _trackedBytes;
+
   };
 
 } // end namespace
@@ -16,12 +16,90 @@
 /** Implements class DAG
  */
 #include "DAG.hpp"
+#include "SimdKernels.hpp"
 
 
 namespace supbub{
 
-  DAG::DAG(int64_t n): Graph(n), candidates() {
+  DAG::DAG(int64_t n): Graph(n, MEM_DAG), candidates() {
     //super();
+    initPreparation();
+    _doubled.preorder = nullptr; // edges are stored
+    _endEdges = nullptr;
+  }
+
+  DAG::DAG(const DoubledView& view): Graph(2 * view.offset + 2, MEM_DAG, false), candidates() {
+    initPreparation();
+    _doubled = view;
+    _endEdges = new uint8_t[_numVertices];
+    std::fill_n(_endEdges, _numVertices, 0);
+    _arrayBytes = sizeof(uint8_t) * _numVertices;
+    memoryChanged(MEM_DAG, _arrayBytes);
+    int64_t_LIST_ITERATOR i;
+    int64_t offset = view.offset;
+    int64_t source = getSourceId();
+    int64_t terminal = getTerminalId();
+    int64_t sgSource = offset; // r and r' in the subgraph
+    int64_t sgTerminal = offset + 1;
+
+    /* {(r, v' ) | (r, v) ∈ E(G)} and {(v'' , r' ) | (v, r' ) ∈ E(G)} */
+    for (i = view.children[sgSource].begin(); i != view.children[sgSource].end(); ++i) {
+      if (*i != sgTerminal) {
+	_endEdges[*i] |= FROM_SOURCE;
+      }
+    }
+    for (i = view.parents[sgTerminal].begin(); i != view.parents[sgTerminal].end(); ++i) {
+      if (*i != sgSource) {
+	_endEdges[*i + offset] |= TO_TERMINAL;
+      }
+    }
+    _sourceFromSubgraph = !view.children[sgSource].empty();
+    _terminalFromSubgraph = !view.parents[sgTerminal].empty();
+
+    /* Degrees of {(u', v'), (u'', v'') |(u, v) ∈ E(G), (u, v) is not a back edge } and {(u', v'') | (u, v) ∈ E(G), (u, v) is a back edge} */
+    for (int64_t u = 0; u < offset; ++u) {
+      for (i = view.children[u].begin(); i != view.children[u].end(); ++i) {
+	int64_t v = *i;
+	if (v == sgTerminal) {
+	  continue;
+	}
+	_outDegree[u]++;
+	if (isBackEdge(u, v)) {
+	  _inDegree[v + offset]++;
+	} else {
+	  _inDegree[v]++;
+	  _outDegree[u + offset]++;
+	  _inDegree[v + offset]++;
+	}
+      }
+    }
+
+    /* Edges from r and to r': those of the subgraph, or else (r, u) for every u without parent and (u, r') for every u without child */
+    for (int64_t u = 0; u < source; ++u) {
+      if (!_sourceFromSubgraph && _inDegree[u] == 0) {
+	_endEdges[u] |= FROM_SOURCE;
+      }
+      if ((_endEdges[u] & FROM_SOURCE) != 0) {
+	_inDegree[u]++;
+	_outDegree[source]++;
+      }
+    }
+    for (int64_t u = 0; u < source; ++u) {
+      if (!_terminalFromSubgraph && _outDegree[u] == 0) {
+	_endEdges[u] |= TO_TERMINAL;
+      }
+      if ((_endEdges[u] & TO_TERMINAL) != 0) {
+	_outDegree[u]++;
+	_inDegree[terminal]++;
+      }
+    }
+    for (int64_t u = 0; u < _numVertices; ++u) {
+      _numEdges += _outDegree[u];
+    }
+  }
+
+  void
+  DAG::initPreparation(){
     // Following will be prepared by prepareForSupBub() 
     ordD = nullptr;
     invOrd = nullptr;
@@ -30,6 +108,11 @@ namespace supbub{
     outChild = nullptr;
     rmqOutParent = nullptr;
     rmqOutChild = nullptr;
+    blockRmqOutParent = nullptr;
+    blockRmqOutChild = nullptr;
+    _relabelled = false;
+    _arrayBytes = 0;
+    _rmqBytes = 0;
   }
 
   DAG::~DAG() {
@@ -54,6 +137,17 @@ namespace supbub{
     if (rmqOutChild != nullptr) {
       delete rmqOutChild;
     }
+    if (blockRmqOutParent != nullptr) {
+      delete blockRmqOutParent;
+    }
+    if (blockRmqOutChild != nullptr) {
+      delete blockRmqOutChild;
+    }
+    if (_endEdges != nullptr) {
+      delete[] _endEdges;
+    }
+    memoryChanged(MEM_DAG, -_arrayBytes);
+    memoryChanged(MEM_RMQ, -_rmqBytes);
   }
 
   int64_t
@@ -67,9 +161,12 @@ namespace supbub{
   }
 
   void
-  DAG::prepareForSupBub(){
+  DAG::prepareForSupBub(bool relabel, bool blockRmq){
 
     /* Compute topological order */
+    int64_t arrayBytes = 5 * sizeof(int64_t) * _numVertices; // invOrd, ordD, pvsEntrance, outParent, outChild
+    _arrayBytes += arrayBytes;
+    memoryChanged(MEM_DAG, arrayBytes);
     invOrd = new int64_t[_numVertices];
     fillTopologicalOrder();
 
@@ -78,44 +175,31 @@ namespace supbub{
     for (int64_t ord = 0; ord < _numVertices; ++ord) {
       ordD[invOrd[ord]] = ord; 
     }
+    if (relabel) {
+      relabelInTopologicalOrder();
+    }
 
     /* Compute candidate list. Along with it pvsEntrance */
     pvsEntrance = new Candidate*[_numVertices];
     prepareCandListNPvsEntrance();
+    candidates.updateTrackedMemory();
 
     /* Compute outParent and outChild and prepare for RMQ */
     outParent = new int64_t[_numVertices];
     outChild = new int64_t[_numVertices];
-    prepareOutParNOutChildRMQ();
+    prepareOutParNOutChildRMQ(blockRmq);
 
   }
 
-  Candidate*
-  DAG::previousEntrance(int64_t v){
-    if (v < _numVertices && v >= 0)  {
-      return pvsEntrance[v];
-    } else {
-      log("Invalid v: ", v);
-      return nullptr;
-    }
-  }
-
-  int64_t
-  DAG::vertexAtOrder(int64_t o){
-    if (o < _numVertices && o >= 0) {
-      return invOrd[o];
-    } else {
-     log("Invalid order: ", o);
-      return -1;
-    }
-  }
-
   int64_t
   DAG::rangeMaxOutChild(int64_t start, int64_t end){
     int64_t l_rmq, r_rmq;
     if(start < end){l_rmq=start; r_rmq=end;}
     else{l_rmq=end; r_rmq=start;}
-    return outChild[(*rmqOutChild)(r_rmq, l_rmq)];
+    if (blockRmqOutChild != nullptr) {
+      return blockRmqOutChild->query(l_rmq, r_rmq);
+    }
+    return outChild[(*rmqOutChild)(l_rmq, r_rmq)];
   }
 
   int64_t
@@ -123,28 +207,145 @@ namespace supbub{
     int64_t l_rmq, r_rmq;
     if(start < end){l_rmq=start; r_rmq=end;}
     else{l_rmq=end; r_rmq=start;}
+    if (blockRmqOutParent != nullptr) {
+      return blockRmqOutParent->query(l_rmq, r_rmq);
+    }
     return outParent[(*rmqOutParent)(l_rmq, r_rmq)];
   }
 
+  void
+  DAG::cutOrders(int64_t minSpacing, std::vector<int64_t>& cuts){
+    int64_t last = 0;
+    int64_t prefixMax = -1; // largest OutChild of the orders before o
+    for (int64_t o = 1; o + minSpacing < _numVertices; ++o) {
+      prefixMax = std::max(prefixMax, outChild[o - 1]);
+      if (prefixMax <= o && o - last >= minSpacing) {
+	Candidate* entrance = pvsEntrance[vertexAtOrder(o)];
+	if (entrance != nullptr && entrance->vertexId == vertexAtOrder(o)) {
+	  cuts.push_back(o);
+	  last = o;
+	}
+      }
+    }
+  }
+
 
   //////////////////////// private ////////////////////////
 
+  template<class F>
+  bool
+  DAG::findChild(int64_t v, F f){
+    int64_t_LIST_ITERATOR i;
+    if (_doubled.preorder == nullptr) { // edges are stored
+      for (i = _adjList[v].begin(); i != _adjList[v].end(); ++i) {
+	if (f(*i)) {
+	  return true;
+	}
+      }
+      return false;
+    }
+    int64_t offset = _doubled.offset;
+    int64_t source = getSourceId();
+    if (v == source) {
+      if (_sourceFromSubgraph) {
+	for (i = _doubled.children[offset].begin(); i != _doubled.children[offset].end(); ++i) {
+	  if (*i != offset + 1 && f(*i)) {
+	    return true;
+	  }
+	}
+      } else {
+	for (int64_t u = 0; u < source; ++u) {
+	  if ((_endEdges[u] & FROM_SOURCE) != 0 && f(u)) {
+	    return true;
+	  }
+	}
+      }
+      return false;
+    }
+    if (v == getTerminalId()) {
+      return false;
+    }
+    bool toTerminal = ((_endEdges[v] & TO_TERMINAL) != 0);
+    if (toTerminal && _terminalFromSubgraph && f(getTerminalId())) {
+      return true;
+    }
+    bool duplicate = (v >= offset);
+    int64_t u = duplicate ? v - offset : v;
+    for (i = _doubled.children[u].begin(); i != _doubled.children[u].end(); ++i) {
+      int64_t c = *i;
+      if (c == offset + 1) { // r' of the subgraph
+	continue;
+      }
+      if (isBackEdge(u, c)) {
+	if (!duplicate && f(c + offset)) { // u'-c''
+	  return true;
+	}
+      } else if (f(duplicate ? c + offset : c)) { // u'-c' or u''-c''
+	return true;
+      }
+    }
+    return (toTerminal && !_terminalFromSubgraph && f(getTerminalId()));
+  }
+
+  template<class F>
+  bool
+  DAG::findParent(int64_t v, F f){
+    int64_t_LIST_ITERATOR i;
+    if (_doubled.preorder == nullptr) { // edges are stored
+      for (i = _parentList[v].begin(); i != _parentList[v].end(); ++i) {
+	if (f(*i)) {
+	  return true;
+	}
+      }
+      return false;
+    }
+    int64_t offset = _doubled.offset;
+    int64_t source = getSourceId();
+    if (v == getTerminalId()) {
+      for (int64_t u = 0; u < source; ++u) {
+	if ((_endEdges[u] & TO_TERMINAL) != 0 && f(u)) {
+	  return true;
+	}
+      }
+      return false;
+    }
+    if (v == source) {
+      return false;
+    }
+    if ((_endEdges[v] & FROM_SOURCE) != 0 && f(source)) {
+      return true;
+    }
+    bool duplicate = (v >= offset);
+    int64_t u = duplicate ? v - offset : v;
+    for (i = _doubled.parents[u].begin(); i != _doubled.parents[u].end(); ++i) {
+      int64_t p = *i;
+      if (p == offset) { // r of the subgraph
+	continue;
+      }
+      if (isBackEdge(p, u)) {
+	if (duplicate && f(p)) { // p'-u''
+	  return true;
+	}
+      } else if (f(duplicate ? p + offset : p)) { // p'-u' or p''-u''
+	return true;
+      }
+    }
+    return false;
+  }
+
   void
   DAG::fillTopologicalOrder(){
-    std::stack<int64_t> ordStack;
-
     bool* visited = new bool[_numVertices];
     std::fill_n( visited, _numVertices, 0 ); // set to false
-
-    // Call topologicalSort for each unvisited source node
- 
-    topologicalSort(getSourceId(), visited, ordStack);
-  
-    // Return result
-    int64_t i=0;
-    while (!ordStack.empty()) {
-      invOrd[i++] = ordStack.top();
-      ordStack.pop();
+    std::vector<int64_t> dfsStack;
+
+    // The source first (every vertex is reached from it), then any vertex left
+    int64_t position = _numVertices;
+    topologicalSort(getSourceId(), visited, dfsStack, position);
+    for (int64_t v = 0; v < _numVertices; ++v) {
+      if (!visited[v]) {
+	topologicalSort(v, visited, dfsStack, position);
+      }
     }
 
     // clean up;
@@ -152,57 +353,104 @@ namespace supbub{
   }
 
   void
-  DAG::topologicalSort(int64_t v, bool* visited, std::stack<int64_t> &ordStack){
-    // Mark the current node as visited.
-    visited[v] = true;
- 
-    // Recursive call for all the children of this vertex
-    int64_t_LIST_ITERATOR i;
-    if (! _adjList[v].empty()) {
-      for (i = _adjList[v].begin(); i != _adjList[v].end(); ++i) {
-	if (!visited[*i]){
-	  topologicalSort(*i, visited, ordStack);
-	}
+  DAG::topologicalSort(int64_t root, bool* visited, std::vector<int64_t>& dfsStack, int64_t& position){
+    // An entry v is a vertex to visit, ~v a vertex whose children have all been visited.
+    // The children are pushed in reverse order, so that they are visited in the order of the edges, as a recursive DFS does.
+    dfsStack.push_back(root);
+    while (!dfsStack.empty()) {
+      int64_t v = dfsStack.back();
+      dfsStack.pop_back();
+      if (v < 0) { // finished: it precedes the vertices finished before it
+	invOrd[--position] = ~v;
+	continue;
       }
+      if (visited[v]) { // reached again through another parent
+	continue;
+      }
+      visited[v] = true;
+      dfsStack.push_back(~v);
+      size_t first = dfsStack.size();
+      findChild(v, [&](int64_t c) {
+	  if (!visited[c]){
+	    dfsStack.push_back(c);
+	  }
+	  return false;
+	});
+      std::reverse(dfsStack.begin() + first, dfsStack.end());
     }
- 
-    // Push current vertex to stack which stores result
-    ordStack.push(v);
-
   }
 
 
+  void
+  DAG::relabelInTopologicalOrder(){
+    ADJACENCY adjList{new int64_t[_numVertices + 1], new int64_t[_numEdges]};
+    ADJACENCY parentList{new int64_t[_numVertices + 1], new int64_t[_numEdges]};
+    int64_t* inDegree = new int64_t[_numVertices];
+    int64_t* outDegree = new int64_t[_numVertices];
+    int64_t newBytes = sizeof(int64_t) * (4 * _numVertices + 2 + 2 * _numEdges);
+    memoryChanged(MEM_DAG, newBytes);
+
+    int64_t numChildren = 0;
+    int64_t numParents = 0;
+    for (int64_t ord = 0; ord < _numVertices; ++ord) {  // in topo-order
+      int64_t v = invOrd[ord];
+      adjList.start[ord] = numChildren;
+      findChild(v, [&](int64_t c) { adjList.ids[numChildren++] = ordD[c]; return false; });
+      parentList.start[ord] = numParents;
+      findParent(v, [&](int64_t p) { parentList.ids[numParents++] = ordD[p]; return false; });
+      inDegree[ord] = _inDegree[v];
+      outDegree[ord] = _outDegree[v];
+    }
+    adjList.start[_numVertices] = numChildren;
+    parentList.start[_numVertices] = numParents;
+
+    delete[] _adjList.start;
+    delete[] _adjList.ids;
+    delete[] _parentList.start;
+    delete[] _parentList.ids;
+    delete[] _inDegree;
+    delete[] _outDegree;
+    _adjList = adjList;
+    _parentList = parentList;
+    _inDegree = inDegree;
+    _outDegree = outDegree;
+    memoryChanged(MEM_DAG, -newBytes);
+    updateTrackedMemory(); // (a doubled DAG had no adjacency arrays)
+
+    // edges are now stored
+    if (_endEdges != nullptr) {
+      delete[] _endEdges;
+      _endEdges = nullptr;
+      memoryChanged(MEM_DAG, -int64_t(sizeof(uint8_t)) * _numVertices);
+      _arrayBytes -= sizeof(uint8_t) * _numVertices;
+    }
+    _doubled.preorder = nullptr;
+
+    // ordD is now the identity; invOrd maps new id to original id
+    delete[] ordD;
+    ordD = nullptr;
+    memoryChanged(MEM_DAG, -int64_t(sizeof(int64_t)) * _numVertices);
+    _arrayBytes -= sizeof(int64_t) * _numVertices;
+    _relabelled = true;
+  }
+
   void
   DAG::prepareCandListNPvsEntrance(){
-    int64_t_LIST_ITERATOR i;  
     int64_t ver;
-    bool exitDone, entranceDone;
     Candidate* pvsEnt = nullptr;
     for (int64_t ord = 0; ord < _numVertices; ++ord) {  // in topo-order
-      ver = invOrd[ord];
-      exitDone = false;
-      entranceDone= false;    
+      ver = vertexAtOrder(ord);
 
       // check if an exit candidate
-      if (! _parentList[ver].empty()) {
-	for (i = _parentList[ver].begin(); !exitDone && i != _parentList[ver].end(); ++i) {
-	  if (_outDegree[*i] == 1) {  // a parent with only one child 
-	    Candidate* pCand = candidates.insert((int64_t)ver, false,pvsEnt);
-	    exitDone = true;
-	  }
-	}
+      if (findParent(ver, [this](int64_t p) { return _outDegree[p] == 1; })) {  // a parent with only one child 
+	candidates.insert(ver, false, pvsEnt);
       }
       
       // check if an entrance candidate
-      if (! _adjList[ver].empty()) {
-	for (i = _adjList[ver].begin(); !entranceDone && i != _adjList[ver].end(); ++i) {
-	  if (_inDegree[*i] == 1) { // a child with only one parent 
-	    Candidate* pCand = candidates.insert(ver, true, nullptr);
-	    entranceDone = true;
-	    // this is previous entrance for coming vertices until next ent
-	    pvsEnt = pCand; 
-	  }
-	}
+      if (findChild(ver, [this](int64_t c) { return _inDegree[c] == 1; })) { // a child with only one parent 
+	Candidate* pCand = candidates.insert(ver, true, nullptr);
+	// this is previous entrance for coming vertices until next ent
+	pvsEnt = pCand; 
       }
       // fill previous entrance for this node
       pvsEntrance[ver] = pvsEnt;
@@ -211,39 +459,40 @@ namespace supbub{
 
 
   void
-  DAG::prepareOutParNOutChildRMQ(){   
-
-    int64_t_LIST_ITERATOR i;
-    int64_t minOrd, maxOrd;
+  DAG::prepareOutParNOutChildRMQ(bool blockRmq){   
 
     for (int64_t v = 0; v < _numVertices; ++v){
-       // fill outParent
-      minOrd = _numVertices;
-      if (! _parentList[v].empty()) {
-	for (i = _parentList[v].begin(); i != _parentList[v].end(); ++i){   
-	  if(ordD[(*i)] < minOrd){ // furthest parent
-	    minOrd = ordD[(*i)];
-	  }
-	}
-      }
-      outParent[ordD[v]] = minOrd;
-
-      // fill outChild
-      maxOrd = -1;
-      if (! _adjList[v].empty()) {
-	for (i = _adjList[v].begin(); i != _adjList[v].end(); ++i){
-	  if(ordD[*i] > maxOrd){ // furthest child
-	    maxOrd = ordD[*i];
-	  }
-	}
+      if (_doubled.preorder != nullptr) { // edges of a doubled DAG are not stored: no gather
+	int64_t furthestParent = _numVertices;
+	findParent(v, [&](int64_t p) { furthestParent = std::min(furthestParent, order(p)); return false; });
+	outParent[order(v)] = furthestParent;
+	int64_t furthestChild = -1;
+	findChild(v, [&](int64_t c) { furthestChild = std::max(furthestChild, order(c)); return false; });
+	outChild[order(v)] = furthestChild;
+	continue;
       }
-	outChild[ordD[v]] = maxOrd;
+      // fill outParent with the order of the furthest parent 
+      int64_t_LIST parents = _parentList[v];
+      outParent[order(v)] = gatherMin(parents.begin(), parents.size(), ordD, _numVertices);
+
+      // fill outChild with the order of the furthest child
+      int64_t_LIST children = _adjList[v];
+      outChild[order(v)] = gatherMax(children.begin(), children.size(), ordD, -1);
     }
 
     // prepare for RMQ
+    if (blockRmq) {
+      blockRmqOutParent = new BlockRMQ(outParent, _numVertices, true);
+      blockRmqOutChild = new BlockRMQ(outChild, _numVertices, false);
+      _rmqBytes = blockRmqOutParent->sizeInBytes() + blockRmqOutChild->sizeInBytes();
+      memoryChanged(MEM_RMQ, _rmqBytes);
+      return;
+    }
 
     // create a vector of length len and initialize it with 0s
     sdsl::int_vector<> v(_numVertices , 0 ); 
+    int64_t copyBytes = sdsl::size_in_bytes(v);
+    memoryChanged(MEM_RMQ, copyBytes);
     for(int64_t i = 0; i < _numVertices; i++){
       v[i] = outParent[i];
     }
@@ -257,7 +506,8 @@ namespace supbub{
     rmqOutChild = new sdsl::rmq_succinct_sct<false>(&v);
 
     sdsl::util::clear(v);
+    _rmqBytes = sdsl::size_in_bytes(*rmqOutParent) + sdsl::size_in_bytes(*rmqOutChild);
+    memoryChanged(MEM_RMQ, _rmqBytes - copyBytes);
   }
 
 }// end namespace
- 
@@ -22,6 +22,7 @@
 
 #include "Graph.hpp"
 #include "CandidateList.hpp"
+#include "BlockRMQ.hpp"
 
 #include <sdsl/rmq_support.hpp>	
 
@@ -30,6 +31,12 @@ namespace supbub{
   /** Class DAG
    * A DAG is a graph represented as follows:
    *   - A vertex is represented by its vertex-id(local-id). Therefore in this file, vertex v means vertex with id=v.
+   *   - Its edges are either stored (added as in Graph), or, for the DAG of a cyclic subgraph (a 'doubled' DAG), derived from the subgraph:
+   *     -- The DAG of a subgraph has two vertices u' (id u) and u'' (id u + offset) for each vertex u of the subgraph, a source r (id 2*offset) and a terminal r' (id 2*offset + 1) (see Subgraph).
+   *     -- An edge u-v of the subgraph gives u'-v' and u''-v'' if it is not a back edge of the DFS of the subgraph, u'-v'' otherwise. It is a back edge if v is u or an ancestor of u, which the DFS index of the subgraph answers.
+   *     -- So the children and parents of u' and u'' are found from those of u in the subgraph, and only the degrees and a flag per vertex for the edges from r and to r' are stored (not the edges of the two copies).
+   *     -- Children are given in the order in which the edges would have been added (the topological order is the same as if the edges were stored).
+   *     -- getChildren() and getParents() are not available on a doubled DAG (they are only used within this class, through findChild() and findParent()), and no edge can be added to it.
    *
    * This implementation is based on the paper "Linear-Time Superbubble Identification Algorithm for  Genome Assembly" by Brankovic et.al.
    *
@@ -44,6 +51,7 @@ namespace supbub{
    *     --- Vertex at a given order
    *     --- Range maximum query on OutChild
    *     --- Range minimum query on OutParent
+   *     --- Orders at which the DAG can be cut
    *
    */
 
@@ -65,14 +73,30 @@ namespace supbub{
 
     /** array of topological order of vertices
      * ordD[x] = y => vertex with id=x has y as topological order
+     * It is nullptr if the vertices have been relabelled in topological order (then the id of a vertex is its order).
      */
     int64_t* ordD;
 
+    /** type for the view of a doubled DAG on its subgraph (see above); the arrays are those of the subgraph, not copied */
+    struct DoubledView{
+      ADJACENCY children;             // children of the vertices of the subgraph
+      ADJACENCY parents;              // parents of the vertices of the subgraph
+      const uint32_t* preorder;       // preorder number of each vertex of the subgraph in its DFS
+      const uint32_t* lastInSubtree;  // largest preorder number in the DFS subtree of each vertex of the subgraph
+      int64_t offset;                 // number of vertices of the subgraph except r (id offset) and r' (id offset + 1)
+    };
+
     /** Constructor
      * @param n total number of vertices
      */
     DAG(int64_t n); 
 
+    /** Constructor of the doubled DAG of a cyclic subgraph (the GraphToDAG method, see Subgraph::getDAG()).
+     * The view has to remain valid as long as the DAG is used (until prepareForSupBub() if it relabels the vertices, which stores the edges).
+     * @param view adjacency and DFS index of the subgraph.
+     */
+    DAG(const DoubledView& view); 
+
     /** Destructor */ 
     ~DAG();
 
@@ -96,23 +120,50 @@ namespace supbub{
      *  - Following is accomplished while this DAG prepares itself for detection:
      *     -- Generating Candidate List
      *     -- Filling invOrd array 
-     *     -- Filling ordD array
+     *     -- Filling ordD array (or relabelling the vertices in topological order)
      *     -- Filling pvsEntrance array 
      *     -- Preparing OutParent and OutChild for rmq
+     * @param relabel if true, vertices are renumbered so that the id of a vertex is its topological order.
+     *        ordD is then not needed (it is the identity) and adjacency, pvsEntrance, outParent and outChild are accessed sequentially during detection. 
+     *        The edges of a doubled DAG are then stored (in the new order).
+     *        Ids in the candidate list are then the new ids; use originalId() to get back the id the vertex had when the DAG was built. 
+     * @param blockRmq if true, rmq on OutParent and OutChild is answered by BlockRMQ instead of the succinct rmq of sdsl.
      */
-    void prepareForSupBub();
+    void prepareForSupBub(bool relabel = false, bool blockRmq = false);
+
+    /** Returns the topological order of the vertex v. */
+    int64_t order(int64_t v) { return (ordD == nullptr) ? v : ordD[v]; }
+
+    /** Returns the id that the vertex v had before relabelling (v itself if the DAG has not been relabelled). */
+    int64_t originalId(int64_t v) { return _relabelled ? invOrd[v] : v; }
 
     /** Returns the pointer to previous entrance, in the candidate list, for the given vertex.
     * **See comments for pvsEntrance array in Graph.hpp** 
      * @param v vertex whose previous entrance is to be found
-     * @return pointer to previous entrance for v or nullptr if v is invalid
+     * @return pointer to previous entrance for v or nullptr if v is invalid (checked build only)
      */
-    Candidate* previousEntrance(int64_t v);
+    Candidate* previousEntrance(int64_t v) {
+#if SUPBUB_CHECKED
+      if (v >= _numVertices || v < 0) {
+	invalidId("Invalid v: ", v);
+	return nullptr;
+      }
+#endif
+      return pvsEntrance[v];
+    }
 
 
-    /** Returns the vertex having the given topological order.
+    /** Returns the vertex having the given topological order (or -1 if o is invalid, checked build only).
      */
-    int64_t vertexAtOrder(int64_t o);
+    int64_t vertexAtOrder(int64_t o) {
+#if SUPBUB_CHECKED
+      if (o >= _numVertices || o < 0) {
+	invalidId("Invalid order: ", o);
+	return -1;
+      }
+#endif
+      return _relabelled ? o : invOrd[o];
+    }
 
     /** Returns the maximum OutChild in the given range .
      */
@@ -122,15 +173,27 @@ namespace supbub{
      */
     int64_t rangeMinOutParent(int64_t start, int64_t end);
 
+    /** Gives orders at which the DAG can be cut: every edge from a vertex before the cut goes to a vertex not after it (the largest OutChild of the prefix is the cut), so that every path goes through the vertex of the cut.
+     * Only the vertices which are entrance candidates are taken, the first one at least minSpacing after the previous cut (or the source) and at least minSpacing before the terminal.
+     * Assumes that prepareForSupBub() has been called.
+     * @param minSpacing smallest number of orders between two cuts.
+     * @param cuts reference to the vector to which the orders are added (increasing).
+     */
+    void cutOrders(int64_t minSpacing, std::vector<int64_t>& cuts);
+
  
     //////////////////////// private ////////////////////////
   private:
 
     /** array of ids of vertices indexed by topological order
      * invOrd[x] = y => vertex y has x as topological order
+     * After relabelling, it maps a new id (which is also the order) to the original id.
      */
     int64_t* invOrd;
 
+    /** true if the vertices have been relabelled in topological order */
+    bool _relabelled;
+
     /** array of outParent
      * OutParent[ordD[v]] = ordD[u1 ] such that
      *                       ordD[u1 ] is the minimum ∀ui → v, i.e.
@@ -165,18 +228,73 @@ namespace supbub{
     /** OutChild array prepared to answer rmq in constant time */
     sdsl::rmq_succinct_sct<false>* rmqOutChild;
 
+    /** OutParent array prepared to answer rmq with BlockRMQ (used instead of rmqOutParent if not nullptr) */
+    BlockRMQ* blockRmqOutParent;
+
+    /** OutChild array prepared to answer rmq with BlockRMQ (used instead of rmqOutChild if not nullptr) */
+    BlockRMQ* blockRmqOutChild;
+
+    /** number of bytes of ordD, invOrd, pvsEntrance, outParent, outChild and _endEdges accounted so far */
+    int64_t _arrayBytes;
+
+    /** flags of _endEdges */
+    static const uint8_t FROM_SOURCE = 1; // edge r-v
+    static const uint8_t TO_TERMINAL = 2; // edge v-r'
+
+    /** view on the subgraph of a doubled DAG (preorder is nullptr if the edges are stored) */
+    DoubledView _doubled;
+
+    /** array of flags of a doubled DAG: _endEdges[v] tells whether there are edges r-v and v-r' (nullptr if the edges are stored) */
+    uint8_t* _endEdges;
+
+    /** true if the edges r-v' of a doubled DAG come from the edges of r in the subgraph (in their order), false if they were added to the vertices without parent */
+    bool _sourceFromSubgraph;
+
+    /** true if the edges v''-r' of a doubled DAG come from the edges to r' in the subgraph (they precede the other children of v''), false if they were added to the vertices without child (last child) */
+    bool _terminalFromSubgraph;
+
+    /** Sets the members of the DAG prepared by prepareForSupBub() to nothing (common to the constructors). */
+    void initPreparation();
+
+    /** Tells whether the edge u-v of the subgraph of a doubled DAG is a back edge of its DFS (v is u or an ancestor of u). */
+    bool isBackEdge(int64_t u, int64_t v) { return uint32_t(_doubled.preorder[u] - _doubled.preorder[v]) <= uint32_t(_doubled.lastInSubtree[v] - _doubled.preorder[v]); }
+
+    /** Calls f(c) for each child c of v, in the order of the edges, until f returns true.
+     * @return true if f returned true for a child, false otherwise.
+     */
+    template<class F>
+    bool findChild(int64_t v, F f);
+
+    /** Calls f(p) for each parent p of v until f returns true.
+     * @return true if f returned true for a parent, false otherwise.
+     */
+    template<class F>
+    bool findParent(int64_t v, F f);
+
+    /** number of bytes of the rmq structures accounted so far */
+    int64_t _rmqBytes;
+
     /** Fills the invOrd array with vertices in topological order 
      */
     void fillTopologicalOrder();
 
-    /** Sorts the vertices in topological order recursively by using DFS.
-     * @param currentVertex vertex under consideration.
-     * @param visited array marking the visisted vertices.
-     * @param ordStack stack storing the result.
+    /** Sorts the vertices reached from a vertex in topological order by an iterative DFS (reverse postorder, children in the order of the edges).
+     * A DFS order is needed by the detection: the vertices of a superbubble are then consecutive (which is not so in any topological order, e.g. by levels).
+     * @param root vertex from which the DFS starts.
+     * @param visited array marking the visited vertices.
+     * @param dfsStack stack of vertices to visit (empty, and left empty).
+     * @param position reference to the position in invOrd before which the vertices are written, from the last one (updated).
+     */
+    void topologicalSort(int64_t root,
+			 bool* visited,
+			 std::vector<int64_t>& dfsStack,
+			 int64_t& position);
+
+    /** Renumbers the vertices so that the id of a vertex is its topological order.
+     * Adjacency lists are rebuilt in the new order (so that neighbouring orders are close in memory), ordD is released.
+     * Assumes invOrd and ordD have been filled.
      */
-    void topologicalSort(int64_t currentVertex, 
-			 bool* visited, 
-			 std::stack<int64_t> &ordStack);
+    void relabelInTopologicalOrder();
 
  
     /** Genertaes Candidate List and fills pvsEntrance array.
@@ -193,13 +311,14 @@ namespace supbub{
     void prepareCandListNPvsEntrance();
 
     /** Generates OutChild and OutParent and preapres them to answer rmq in constant time.
+     * The furthest parent/child of a vertex is found with the SIMD gather kernels over its (contiguous) adjacency list.
      * OutChild[x] = y implies y is the order of the furthest(topologically) child of the vertex having order x. Or
      * OutChild[ordD[v]] = ordD[u2] | ordD[u2] is the maximum among all children of v.
      * OutParent[x] = y implies y is the order of the furthest(topologically) parent of the vertex having order x. Or
      * OutParent[ordD[v]] = ordD[u2] | ordD[u2] is the minimum among all parents of v.
      *
      */
-    void prepareOutParNOutChildRMQ();
+    void prepareOutParNOutChildRMQ(bool blockRmq);
 
  
   };
@@ -17,238 +17,823 @@
  */
 #include "DetectSuperBubble.hpp"
 
+#include <queue>
+#include <functional>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace supbub {
 
+  /* bytes taken by a superbubble in the list of results (with the links of the list) */
+  static const int64_t RESULT_BYTES = sizeof(DetectSuperBubble::SuperBubble) + 2 * sizeof(void*);
+
+  /* smallest number of vertices (in topological order) between two cuts of a DAG processed in chunks */
+  static const int64_t DAG_CHUNK_VERTICES = 1 << 16;
+
+  /* number of vertices from which a batch of small weakly connected components of singletons is processed as one subgraph */
+  static const int64_t ACYCLIC_BATCH_VERTICES = 1 << 16;
+
+  /* bytes of interior lines a thread buffers before writing them (unordered results only) */
+  static const int64_t INTERIOR_FLUSH_BYTES = 1 << 20;
+
+  /* index of the calling thread in the current team (0 outside of a parallel region) */
+  static inline int
+  threadIndex(){
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+  }
+
+  DetectSuperBubble::DetectSuperBubble() {
+    _options.relabel = false;
+    _options.blockRmq = false;
+    _options.interiorSizes = false;
+    _options.interiorVertices = nullptr;
+    _options.originalIds = nullptr;
+    _options.vertexNames = nullptr;
+    _options.hierarchy = false;
+    _options.numThreads = 1;
+    _options.unordered = false;
+    initWorkspaces();
+  }
+
+  DetectSuperBubble::DetectSuperBubble(Options options) {
+    _options = options;
+    initWorkspaces();
+  }
+
+  DetectSuperBubble::~DetectSuperBubble() {
+    for (Workspace* ws : _workspaces) {
+      memoryChanged(MEM_CANDIDATES, -ws->nestedSearchesBytes);
+      delete ws;
+    }
+  }
+
+  void
+  DetectSuperBubble::initWorkspaces(){
+    int numThreads = std::max(_options.numThreads, 1);
+#ifndef _OPENMP
+    numThreads = 1;
+#endif
+    for (int t = 0; t < numThreads; ++t) {
+      _workspaces.push_back(new Workspace());
+    }
+  }
+
+  /* Adds the edges of the subgraph coming from vertex v of g (see PartitionGraph in paper-1):
+   *  - edge v-u for each child u in the same subgraph.
+   *  - edge v-r' if v has a child in another subgraph (or no child at all and v is a singleton).
+   *  - edge r-v if v has a parent in another subgraph (or no parent at all and v is a singleton).
+   * Subgraphs with id less than numAcyclic are made of singletons.
+   * Edges are given to addEdge(x, y) with local-ids.
+   */
+  template<class ADD_EDGE>
+  static void
+  partitionEdges(Graph& g, int64_t v, int64_t* scc, int64_t numAcyclic, int64_t* globalToLocalIdMap, int64_t sourceId, int64_t terminalId, ADD_EDGE addEdge){
+    int64_t_LIST_ITERATOR i;
+    bool isOutOtherScc;
+    int64_t_LIST children = g.getChildren(v);
+    if (! children.empty()) { // out-degree non-zero
+      isOutOtherScc = false;
+      for (i = children.begin(); i != children.end(); ++i) {
+	int64_t u = *i;
+	if (scc[v] == scc[u]){ // same scc
+	  addEdge(globalToLocalIdMap[v], globalToLocalIdMap[u]); // add edge v-u
+	}
+	else if (!isOutOtherScc) {  // if this is the first edge out-going to other scc
+	  isOutOtherScc = true; // to avoid mutiple edges between same pair (v-r')
+	  addEdge(globalToLocalIdMap[v], terminalId); // edge v-r'
+	}
+      }
+    }
+    else if (scc[v] < numAcyclic) { // out-degree zero and belongs to a subgraph of singletons
+      addEdge(globalToLocalIdMap[v], terminalId);
+    }
+
+    // add edges r-v
+    int64_t_LIST parents = g.getParents(v);
+    if (! parents.empty()) {
+      for (i = parents.begin(); i != parents.end(); ++i) {
+	int64_t u = *i;
+	if (scc[v] != scc[u]){ // different scc
+	  addEdge(sourceId, globalToLocalIdMap[v]); // add edge r-v
+	  break;
+	}	  
+      }
+    }
+    else if (scc[v] < numAcyclic) { // in-degree zero and belongs to a subgraph of singletons
+      addEdge(sourceId, globalToLocalIdMap[v]);
+    }
+  }
+
   void 
   DetectSuperBubble::find(Graph& g, SUPERBUBBLE_LIST& superBubblesList){
-    int64_t numVertices = g.numVertices();
+    g.finalize();
 
     /*******************************STAGE 1***************************************/
+    // Only the vertices are grouped by subgraph here: each subgraph is built just before it is processed and released right after,
+    // so that at most one subgraph (and its DAG) is in memory at a time.
+    Partition partition;
+    partitionVertices(g, partition);
 
+    /*********************** STAGEs 2 and 3 (combined) ***************************/
+    // (g and partition are only read from here on, so the threads build their subgraphs from them concurrently)
+    findInSubgraphs(partition.numSubgraphs, partition.numAcyclic, [&](int64_t i) { return buildSubgraph(g, partition, i); }, superBubblesList);
+
+    releasePartition(partition);
+  }
+
+  /* Finds the root of the tree of v in a union-find forest (with path halving). */
+  static inline int64_t
+  findRoot(int64_t* parent, int64_t v){
+    while (parent[v] != v) {
+      parent[v] = parent[parent[v]];
+      v = parent[v];
+    }
+    return v;
+  }
+
+  /* Labels the vertices of g with their parts (see DetectSuperBubble::findParts):
+   *  - a vertex of a non-singleton scc gets -1 - (the smallest vertex of its scc).
+   *  - a singleton gets the smallest vertex of its weakly connected component among the singletons: no superbubble spans two of them, so that each one is processed as a subgraph of its own (with its own r and r'), concurrently with the others.
+   * parent and smallest are scratch arrays with an entry per vertex.
+   */
+  static void
+  labelParts(Graph& g, int64_t* part, int64_t* parent, int64_t* smallest){
+    int64_t numVertices = g.numVertices();
     /* Find scc (all singleton-vertices seen as scc with id zero, non-singleton starts from 1) */
-    int64_t* scc = new int64_t[numVertices];
-    int64_t numSubgraphs = g.fillSCC(scc);
+    int64_t numScc = g.fillSCC(part);
+    // union-find forest of the edges between singletons (the root of a tree is its smallest vertex)
+    for (int64_t v = 0; v < numVertices; ++v) {
+      parent[v] = v;
+    }
+    for (int64_t v = 0; v < numVertices; ++v) {
+      if (part[v] != 0) {
+	continue;
+      }
+      int64_t_LIST children = g.getChildren(v);
+      for (int64_t_LIST_ITERATOR i = children.begin(); i != children.end(); ++i) {
+	if (part[*i] == 0) {
+	  int64_t ru = findRoot(parent, *i);
+	  int64_t rv = findRoot(parent, v);
+	  parent[std::max(ru, rv)] = std::min(ru, rv);
+	}
+      }
+    }
+    // smallest vertex of each non-singleton scc
+    std::fill_n(smallest, numScc, -1);
+    for (int64_t v = 0; v < numVertices; ++v) {
+      if (part[v] != 0 && smallest[part[v]] == -1) {
+	smallest[part[v]] = v;
+      }
+    }
+    for (int64_t v = 0; v < numVertices; ++v) {
+      part[v] = (part[v] == 0) ? findRoot(parent, v) : -1 - smallest[part[v]];
+    }
+  }
 
-    /* Preprocess before partitioning */
-    std::vector<Subgraph*> subgraphs;
-    int64_t* globalToLocalIdMap = new int64_t[numVertices]; // Keep track of local-ids given to vertices in each subgraph
-    
-    int64_t* sizeSubgraph = new int64_t[numSubgraphs]; // Keep track of size of each subgraph 
-    std::fill_n(sizeSubgraph, numSubgraphs, 0); // set to 0
-   
-    // Calculate size of ssc/subgraphs, providing local-id to each vertex in that subgraph
-    for(int64_t v=0; v < numVertices; ++v) {
-      globalToLocalIdMap[v] = (sizeSubgraph[scc[v]])++;   
+  void
+  DetectSuperBubble::findParts(Graph& g, int64_t* part){
+    g.finalize();
+    int64_t numVertices = g.numVertices();
+    int64_t* parent = new int64_t[numVertices];
+    int64_t* smallest = new int64_t[numVertices];
+    memoryChanged(MEM_PARTITION, sizeof(int64_t) * 2 * numVertices);
+    labelParts(g, part, parent, smallest);
+    delete[] parent;
+    delete[] smallest;
+    memoryChanged(MEM_PARTITION, -int64_t(sizeof(int64_t)) * 2 * numVertices);
+  }
+
+  void
+  DetectSuperBubble::findInParts(Graph& g, const int64_t* part, const bool* selected, SUPERBUBBLE_LIST& superBubblesList){
+    g.finalize();
+    int64_t numVertices = g.numVertices();
+    Partition partition;
+    allocatePartition(partition, numVertices);
+    std::copy(part, part + numVertices, partition.scc);
+    groupVertices(partition, selected);
+    findInSubgraphs(partition.numSubgraphs, partition.numAcyclic, [&](int64_t i) { return buildSubgraph(g, partition, i); }, superBubblesList);
+    releasePartition(partition);
+  }
+
+  bool
+  DetectSuperBubble::partitionToDisk(Graph& g, PartitionSpill& spill){
+    g.finalize();
+
+    /*******************************STAGE 1***************************************/
+    Partition partition;
+    partitionVertices(g, partition);
+
+    /* PartitionGraph: write the subgraphs one after the other */
+    for(int64_t sg=0; sg < partition.numSubgraphs; ++sg) {
+      int64_t first = partition.firstOfSubgraph[sg];
+      int64_t size = partition.firstOfSubgraph[sg + 1] - first;
+      spill.beginSubgraph(partition.verticesBySubgraph + first, size, sg < partition.numAcyclic);
+      for(int64_t i = first; i < first + size; ++i) {
+	partitionEdges(g, partition.verticesBySubgraph[i], partition.scc, partition.numAcyclic, partition.globalToLocalIdMap, size, size + 1,
+		       [&spill](int64_t x, int64_t y) { spill.addEdge(x, y); });
+      }
     }
+    releasePartition(partition);
 
-    // Create new subgraphs of size just calculated (+ two extra vertices as r and r')
-    for(int64_t sg=0; sg < numSubgraphs; ++sg) {
-      subgraphs.push_back(new Subgraph(sizeSubgraph[sg] +2)); // two additional vetices for r(source) and r'(terminal/sink) resp.
+    bool written = spill.flush();
+    markStage("partition (to disk)");
+    return written;
+  }
 
+  bool
+  DetectSuperBubble::findFromDisk(PartitionSpill& spill, SUPERBUBBLE_LIST& superBubblesList){
+    /*********************** STAGEs 2 and 3 (combined) ***************************/
+    // (the file is shared: one subgraph is read at a time)
+    return findInSubgraphs(spill.numSubgraphs(), spill.numAcyclic(),
+			   [&spill](int64_t i) {
+			     Subgraph* sg;
+#pragma omp critical(readSubgraph)
+			     sg = spill.readSubgraph(i);
+			     return sg;
+			   },
+			   superBubblesList);
+  }
+
+ //////////////////////// private //////////////////////// 
+
+  template<class GET_SUBGRAPH>
+  bool
+  DetectSuperBubble::findInSubgraphs(int64_t numSubgraphs, int64_t numAcyclic, GET_SUBGRAPH getSubgraph, SUPERBUBBLE_LIST& superBubblesList){
+    std::vector<Run> runs(numSubgraphs, Run{0, SUPERBUBBLE_LIST::iterator(), 0, 0});
+    int failed = 0;
+
+    // Subgraphs are handed out one at a time, in the order of their ids (the acyclic ones, often the largest, first).
+    // Each thread appends the superbubbles of a subgraph to its own list: they form a run sorted by entrance.
+#pragma omp parallel for schedule(dynamic, 1) num_threads(_workspaces.size())
+    for(int64_t i=0; i < numSubgraphs; ++i) {
+      int worker = threadIndex();
+      Workspace& ws = *_workspaces[worker];
+      Subgraph* sg = getSubgraph(i);
+      if (sg == nullptr) {
+#pragma omp atomic write
+	failed = 1;
+	continue;
+      }
+      int64_t numFound = ws.found.size();
+      int64_t interiorOffset = ws.interior.tellp();
+      if (i < numAcyclic) { // subgraph of singletons: obtain superbubble for acyclic
+	findInAcyclic(sg, ws);
+      } else { // detect superbubbles after changing cyclic G to acyclic G'
+	findInCyclic(sg, ws);
+      }
+      delete sg;
+      int64_t size = ws.found.size() - numFound;
+      runs[i] = Run{worker, std::prev(ws.found.end(), size), size, interiorOffset};
+      memoryChanged(MEM_RESULTS, int64_t(ws.interior.tellp()) - interiorOffset);
+      if (_options.unordered) {
+	flushInterior(ws, INTERIOR_FLUSH_BYTES);
+      }
+    }
+    markStage("detect");
+    if (failed) {
+      return false;
     }
 
-    /* Start PartitionGraph */
-    int64_t_LIST_ITERATOR i;
-    bool isOutOtherScc, isInOtherScc;
-    for(int64_t v=0; v < numVertices; ++v) {
-      Subgraph* sg = subgraphs[scc[v]];
-      sg->setGlobalId(globalToLocalIdMap[v], v); // set reverse id map for this vertex
-      int64_t_LIST& children = g.getChildren(v);
-      if (! children.empty()) { // out-degree non-zero
-	isOutOtherScc = false;
-	for (i = children.begin(); i != children.end(); ++i) {
-	  int64_t u = *i;
-	  if (scc[v] == scc[u]){ // same scc
-	    sg->addEdge(globalToLocalIdMap[v], globalToLocalIdMap[u]); // add edge v-u
-	  }
-	  else if (!isOutOtherScc) {  // if this is the first edge out-going to other scc
-	    isOutOtherScc = true; // to avoid mutiple edges between same pair (v-r')
-	    sg->addEdge(globalToLocalIdMap[v], sg->getTerminalId()); // edge v-r'
-	  }
-	}
+    if (_options.unordered) { // the lists of the threads one after the other
+      for (Workspace* ws : _workspaces) {
+	superBubblesList.splice(superBubblesList.end(), ws->found);
+	flushInterior(*ws, 0);
       }
-      else if (scc[v] == 0) { // out-degree zero and belongs to singleton subgraph
-	sg->addEdge(globalToLocalIdMap[v], sg->getTerminalId());
+    }
+    else {
+      mergeRuns(runs, superBubblesList);
+    }
+    markStage("merge results");
+    return true;
+  }
+
+  void
+  DetectSuperBubble::mergeRuns(std::vector<Run>& runs, SUPERBUBBLE_LIST& superBubblesList){
+    // text of the buffered interior lines of each workspace
+    std::vector<std::string> interiorTexts(_workspaces.size());
+    int64_t interiorBytes = 0;
+    if (_options.interiorVertices != nullptr) {
+      for (size_t w = 0; w < _workspaces.size(); ++w) {
+	interiorTexts[w] = _workspaces[w]->interior.str();
+	_workspaces[w]->interior.str(std::string());
+	interiorBytes += interiorTexts[w].size();
       }
+    }
 
-      // add edges r-v
-      int64_t_LIST& parents = g.getParents(v);
-      if (! parents.empty()) {
-	for (i = parents.begin(); i != parents.end(); ++i) {
-	  int64_t u = *i;
-	  if (scc[v] != scc[u]){ // different scc
-	    sg->addEdge(sg->getSourceId(), globalToLocalIdMap[v]); // add edge r-v
-	    break;
-	  }	  
+    // heap of the runs not yet consumed, by the entrance of their next superbubble (entrances are unique)
+    typedef std::pair<int64_t, int64_t> RUN_HEAD; // (entrance, run)
+    std::priority_queue<RUN_HEAD, std::vector<RUN_HEAD>, std::greater<RUN_HEAD> > heads;
+    for (size_t r = 0; r < runs.size(); ++r) {
+      if (runs[r].size > 0) {
+	heads.push(RUN_HEAD(runs[r].first->entrance, r));
+      }
+    }
+    while (!heads.empty()) {
+      int64_t r = heads.top().second;
+      heads.pop();
+      Run& run = runs[r];
+      SUPERBUBBLE_LIST::iterator bubble = run.first++;
+      superBubblesList.splice(superBubblesList.end(), _workspaces[run.worker]->found, bubble); // (moved, not copied)
+      if (_options.interiorVertices != nullptr) {
+	const std::string& text = interiorTexts[run.worker];
+	int64_t end = text.find('\n', run.interiorOffset) + 1;
+	_options.interiorVertices->write(text.data() + run.interiorOffset, end - run.interiorOffset);
+	run.interiorOffset = end;
+      }
+      if (--run.size > 0) {
+	heads.push(RUN_HEAD(run.first->entrance, r));
+      }
+    }
+    memoryChanged(MEM_RESULTS, -interiorBytes);
+  }
+
+  void
+  DetectSuperBubble::flushInterior(Workspace& ws, int64_t minBytes){
+    int64_t bytes = ws.interior.tellp();
+    if (_options.interiorVertices == nullptr || bytes == 0 || bytes < minBytes) {
+      return;
+    }
+#pragma omp critical(interiorVertices)
+    *_options.interiorVertices << ws.interior.str();
+    ws.interior.str(std::string());
+    memoryChanged(MEM_RESULTS, -bytes);
+  }
+
+  void
+  DetectSuperBubble::allocatePartition(Partition& partition, int64_t numVertices){
+    partition.numVertices = numVertices;
+    partition.scc = new int64_t[numVertices];
+    partition.globalToLocalIdMap = new int64_t[numVertices]; // Keep track of local-ids given to vertices in each subgraph
+    partition.verticesBySubgraph = new int64_t[numVertices];
+    memoryChanged(MEM_PARTITION, sizeof(int64_t) * 3 * numVertices);
+  }
+
+  void
+  DetectSuperBubble::partitionVertices(Graph& g, Partition& partition){
+    allocatePartition(partition, g.numVertices());
+    /* Find the parts (the two arrays are used as scratch before being filled in) */
+    labelParts(g, partition.scc, partition.verticesBySubgraph, partition.globalToLocalIdMap);
+    groupVertices(partition, nullptr);
+    markStage("scc");
+  }
+
+  void
+  DetectSuperBubble::groupVertices(Partition& partition, const bool* selected){
+    int64_t numVertices = partition.numVertices;
+    int64_t* scc = partition.scc;
+    int64_t* subgraphOfPart = partition.globalToLocalIdMap; // (scratch indexed by the smallest vertex of each part, before being filled in)
+
+    // size of each weakly connected component of singletons
+    std::fill_n(subgraphOfPart, numVertices, 0);
+    for (int64_t v = 0; v < numVertices; ++v) {
+      if ((selected == nullptr || selected[v]) && scc[v] >= 0) {
+	subgraphOfPart[scc[v]]++;
+      }
+    }
+    // Components are grouped in batches of at least ACYCLIC_BATCH_VERTICES vertices (in the order of their smallest vertices), a batch being processed as one subgraph:
+    // the batches are subgraphs 0 to numAcyclic - 1, the non-singleton sccs follow in the same order.
+    int64_t numAcyclic = 0;
+    int64_t batchSize = ACYCLIC_BATCH_VERTICES;
+    for (int64_t v = 0; v < numVertices; ++v) {
+      if ((selected == nullptr || selected[v]) && scc[v] == v) {
+	if (batchSize >= ACYCLIC_BATCH_VERTICES) { // next batch
+	  numAcyclic++;
+	  batchSize = 0;
 	}
+	batchSize += subgraphOfPart[v];
+	subgraphOfPart[v] = numAcyclic - 1;
       }
-      else if (scc[v] == 0) { // in-degree zero and belongs to singleton subgraph
-	sg->addEdge(sg->getSourceId(), globalToLocalIdMap[v]);
+    }
+    int64_t numSubgraphs = numAcyclic;
+    for (int64_t v = 0; v < numVertices; ++v) {
+      if ((selected == nullptr || selected[v]) && scc[v] == -1 - v) {
+	subgraphOfPart[v] = numSubgraphs++;
       }
     }
-    // Clean-up before prceeding to next stages 
-    delete[] scc; 
-    delete[] globalToLocalIdMap;
-    delete[] sizeSubgraph;
+    for (int64_t v = 0; v < numVertices; ++v) {
+      if (selected == nullptr || selected[v]) {
+	scc[v] = subgraphOfPart[smallestOfPart(scc[v])];
+      }
+      else {
+	scc[v] = -1;
+      }
+    }
+    partition.numAcyclic = numAcyclic;
+    partition.numSubgraphs = numSubgraphs;
 
-    /*********************** STAGEs 2 and 3 (combined) ***************************/
+    partition.firstOfSubgraph = new int64_t[numSubgraphs + 1]; // Position of the first vertex of each subgraph in verticesBySubgraph
+    std::fill_n(partition.firstOfSubgraph, numSubgraphs + 1, 0); // set to 0
+    memoryChanged(MEM_PARTITION, sizeof(int64_t) * (numSubgraphs + 1));
+
+    // Calculate size of ssc/subgraphs, providing local-id to each vertex in that subgraph
+    for(int64_t v=0; v < numVertices; ++v) {
+      if (scc[v] >= 0) {
+	partition.globalToLocalIdMap[v] = (partition.firstOfSubgraph[scc[v] + 1])++;
+      }
+    }
+    for(int64_t sg=0; sg < numSubgraphs; ++sg) {
+      partition.firstOfSubgraph[sg + 1] += partition.firstOfSubgraph[sg];
+    }
+
+    // Group the vertices by subgraph, each group in the order of local-ids
+    for(int64_t v=0; v < numVertices; ++v) {
+      if (scc[v] >= 0) {
+	partition.verticesBySubgraph[partition.firstOfSubgraph[scc[v]] + partition.globalToLocalIdMap[v]] = v;
+      }
+    }
+  }
+
+  void
+  DetectSuperBubble::releasePartition(Partition& partition){
+    delete[] partition.scc;
+    delete[] partition.globalToLocalIdMap;
+    delete[] partition.firstOfSubgraph;
+    delete[] partition.verticesBySubgraph;
+    memoryChanged(MEM_PARTITION, -int64_t(sizeof(int64_t)) * (3 * partition.numVertices + partition.numSubgraphs + 1));
+  }
+
+  Subgraph*
+  DetectSuperBubble::buildSubgraph(Graph& g, Partition& partition, int64_t sg){
+    int64_t first = partition.firstOfSubgraph[sg];
+    int64_t size = partition.firstOfSubgraph[sg + 1] - first;
+    Subgraph* subgraph = new Subgraph(size + 2); // two additional vetices for r(source) and r'(terminal/sink) resp.
+
+    // Count the edges first, so that they are stored without spare capacity
+    int64_t numEdges = 0;
+    for(int64_t i = first; i < first + size; ++i) {
+      partitionEdges(g, partition.verticesBySubgraph[i], partition.scc, partition.numAcyclic, partition.globalToLocalIdMap, size, size + 1,
+		     [&numEdges](int64_t x, int64_t y) { numEdges++; });
+    }
+    subgraph->reserveEdges(numEdges);
+
+    for(int64_t i = first; i < first + size; ++i) {
+      int64_t v = partition.verticesBySubgraph[i];
+      subgraph->setGlobalId(i - first, v); // set reverse id map for this vertex
+      partitionEdges(g, v, partition.scc, partition.numAcyclic, partition.globalToLocalIdMap, size, size + 1,
+		     [subgraph](int64_t x, int64_t y) { subgraph->addEdge(x, y); });
+    }
+    subgraph->finalize();
+    return subgraph;
+  }
 
-    /* Obtain superbubble for acyclic */
-    // Subgraph with id 0(corresponding to singletons) is already a Directed Acyclic Graph. Duplicate its edges into a DAG.
-    Subgraph* sg0 = subgraphs[0];
+  void
+  DetectSuperBubble::reportInterior(DAG* dag, Subgraph* sg, bool cyclic, const BubbleInterval& interval, const int64_t* edgePrefix, SuperBubble& bubble, std::ostream& out){
+    bubble.numVertices = interval.last - interval.first + 1;
+    bubble.numEdges = edgePrefix[interval.last] - edgePrefix[interval.first];
+    if (_options.interiorVertices == nullptr) {
+      return;
+    }
+    out << "<";
+    writeVertex(out, bubble.entrance);
+    out << ",";
+    writeVertex(out, bubble.exit);
+    out << ">:";
+    for (int64_t o = interval.first; o <= interval.last; ++o) {
+      int64_t v = dag->originalId(dag->vertexAtOrder(o));
+      if (cyclic && sg->isDuplicateId(v)) { // u'' is u
+	v = sg->getOriginalId(v);
+      }
+      out << " ";
+      writeVertex(out, sg->getGlobalId(v));
+    }
+    out << "\n";
+  }
+
+  void
+  DetectSuperBubble::writeVertex(std::ostream& out, int64_t v){
+    if (_options.vertexNames != nullptr) {
+      _options.vertexNames->write(out, v);
+    }
+    else if (_options.originalIds != nullptr) {
+      out << _options.originalIds[v];
+    }
+    else {
+      out << v;
+    }
+  }
+
+  int64_t*
+  DetectSuperBubble::edgePrefixSums(DAG* dag){
+    int64_t n = dag->numVertices();
+    int64_t* edgePrefix = new int64_t[n + 1];
+    memoryChanged(MEM_DAG, sizeof(int64_t) * (n + 1));
+    edgePrefix[0] = 0;
+    for (int64_t o = 0; o < n; ++o) {
+      edgePrefix[o + 1] = edgePrefix[o] + dag->getOutDegree(dag->vertexAtOrder(o));
+    }
+    return edgePrefix;
+  }
+
+  template<class IS_REPORTED>
+  int64_t
+  DetectSuperBubble::reportedParent(BubbleParent* parents, EpochArray* superBubblesArray, int64_t s, IS_REPORTED isReported){
+    BubbleParent p = parents[s];
+    while (p.entrance != -1 && (superBubblesArray->get(p.entrance) != p.exit || !isReported(p.entrance))) {
+      p = parents[p.entrance];
+    }
+    // shorten the chain of skipped superbubbles
+    int64_t x = parents[s].entrance;
+    while (x != p.entrance) {
+      int64_t next = parents[x].entrance;
+      parents[x] = p;
+      x = next;
+    }
+    return p.entrance;
+  }
+
+  void
+  DetectSuperBubble::findInAcyclic(Subgraph* sg0, Workspace& ws){
+    // A subgraph of singletons is already a Directed Acyclic Graph. Duplicate its edges into a DAG.
+    int64_t_LIST_ITERATOR i;
     int64_t DAGSize = sg0->numVertices();
     DAG* dag0 = new DAG(DAGSize);
 
     for (int64_t v = 0; v < DAGSize; ++v) {
-      int64_t_LIST& children = sg0->getChildren(v);
+      int64_t_LIST children = sg0->getChildren(v);
       if (! children.empty()) { // out-degree non-zero
 	for (i = children.begin(); i != children.end(); ++i) {	
 	  dag0->addEdge(v, *i); // add edge v-u	 
 	}
       }
     }
+    dag0->finalize();
 
-    int64_t* superBubblesArray = new int64_t[DAGSize];
-    std::fill_n(superBubblesArray,DAGSize, -1); // set to -1
+    EpochArray* superBubblesArray = &ws.superBubbles;
+    superBubblesArray->reset(DAGSize); // set to -1
+    bool interior = (_options.interiorSizes || _options.interiorVertices != nullptr);
+    BubbleInterval* intervals = nullptr;
+    if (interior) {
+      intervals = new BubbleInterval[DAGSize];
+      memoryChanged(MEM_DAG, sizeof(BubbleInterval) * DAGSize);
+    }
+    BubbleParent* parents = nullptr;
+    if (_options.hierarchy) {
+      parents = new BubbleParent[DAGSize];
+      memoryChanged(MEM_DAG, sizeof(BubbleParent) * DAGSize);
+    }
     // find superbubles
-    superBubble(dag0, superBubblesArray);
+    superBubble(dag0, ws, superBubblesArray, intervals, parents);
+    int64_t* edgePrefix = interior ? edgePrefixSums(dag0) : nullptr;
 
     // Filter out 'unreal' superbubbles
+    SUPERBUBBLE_LIST& superBubblesList = ws.found;
+    int64_t numFound = superBubblesList.size();
     int64_t lastPossibleS = DAGSize -2; // (last two vertices are dummu source and sink)
     int64_t dumyTerminal = dag0->getTerminalId();
+    auto isReported = [&](int64_t s) {
+      return (s < lastPossibleS && superBubblesArray->get(s) != -1 && superBubblesArray->get(s) != dumyTerminal);
+    };
     for (int64_t s=0; s < lastPossibleS; ++s) {
-      int64_t t = superBubblesArray[s];
+      int64_t t = superBubblesArray->get(s);
       if ( t!= -1 && t!=dumyTerminal) {
-	superBubblesList.push_back(SuperBubble{sg0->getGlobalId(s), sg0->getGlobalId(t)});
+	int64_t parent = -1;
+	if (parents != nullptr) {
+	  parent = reportedParent(parents, superBubblesArray, s, isReported);
+	  parent = (parent == -1) ? -1 : sg0->getGlobalId(parent);
+	}
+	superBubblesList.push_back(SuperBubble{sg0->getGlobalId(s), sg0->getGlobalId(t), 0, 0, parent});
+	if (interior) {
+	  reportInterior(dag0, sg0, false, intervals[s], edgePrefix, superBubblesList.back(), ws.interior);
+	}
       }
 	
     }
 
-    delete sg0;
+    memoryChanged(MEM_RESULTS, RESULT_BYTES * (int64_t(superBubblesList.size()) - numFound));
+
+    if (interior) {
+      delete[] intervals;
+      delete[] edgePrefix;
+      memoryChanged(MEM_DAG, -int64_t(sizeof(BubbleInterval) * DAGSize + sizeof(int64_t) * (DAGSize + 1)));
+    }
+    if (parents != nullptr) {
+      delete[] parents;
+      memoryChanged(MEM_DAG, -int64_t(sizeof(BubbleParent)) * DAGSize);
+    }
     delete dag0;
-    delete[] superBubblesArray;
-    
-    
-    /* Detect superbubbles after changing cyclic G to acyclic G' */
-    for(int64_t i=1; i < numSubgraphs; ++i) {
-      Subgraph* sg = subgraphs[i];
-      DAG* dag = sg->getDAG();
-
-      // Array containing result: superBubblesArray[x] = y => <x,y> is a superbubble.
-      // If x is not an entrance to any superbubble, superBubblesArray[x] = -1 
-      superBubblesArray = new int64_t[dag->numVertices()];
-      std::fill_n(superBubblesArray,dag->numVertices(), -1); // set to -1
-
-      superBubble(dag,superBubblesArray);
-
-      // Filter out 'unreal' superbubbles
-      int64_t lastPossibleS = sg->getOffset();
-      int64_t dumyTerminal = dag->getTerminalId();
-      for (int64_t s=0; s < lastPossibleS; ++s) { // we will only consider u' and not u'' or r' or r''
-	int64_t t = superBubblesArray[s];
-	if ( t!= -1 && t!=dumyTerminal) { // s is entrance of possible 'real' superbubble
-
-	  if (sg->isDuplicateId(t)) { // It corresponds to <s', t''>
-	    int64_t realT = sg->getOriginalId(t);
-	    if (sg->isAncestor(realT, s)) { // if t is ancesstor of s, <s, t> is superbubble
-	      superBubblesList.push_back(SuperBubble{sg->getGlobalId(s), sg->getGlobalId(realT)});
- 
-	    }
-	  }
-	  else { // it corresponds to <s', t'>
-	    int64_t s2 = sg->getDuplicateId(s);
-	    int64_t t2 = sg->getDuplicateId(t);
-	    if (superBubblesArray[s2] == t2) { // if <s'', t''> is also superbubble, then <s, t> is superbubble
-	      superBubblesList.push_back(SuperBubble{sg->getGlobalId(s), sg->getGlobalId(t)});
-	    }
-	  }
+  }
+
+  void
+  DetectSuperBubble::findInCyclic(Subgraph* sg, Workspace& ws){
+    DAG* dag = sg->getDAG();
+
+    // Array containing result: superBubblesArray[x] = y => <x,y> is a superbubble.
+    // If x is not an entrance to any superbubble, superBubblesArray[x] = -1 
+    // (scratch array reused from one DAG to the next, reset in constant time)
+    EpochArray* superBubblesArray = &ws.superBubbles;
+    superBubblesArray->reset(dag->numVertices()); // set to -1
+    bool interior = (_options.interiorSizes || _options.interiorVertices != nullptr);
+    BubbleInterval* intervals = nullptr;
+    if (interior) {
+      intervals = new BubbleInterval[dag->numVertices()];
+      memoryChanged(MEM_DAG, sizeof(BubbleInterval) * dag->numVertices());
+    }
+    BubbleParent* parents = nullptr;
+    if (_options.hierarchy) {
+      parents = new BubbleParent[dag->numVertices()];
+      memoryChanged(MEM_DAG, sizeof(BubbleParent) * dag->numVertices());
+    }
+
+    superBubble(dag, ws, superBubblesArray, intervals, parents);
+    int64_t* edgePrefix = interior ? edgePrefixSums(dag) : nullptr;
+
+    // Filter out 'unreal' superbubbles
+    SUPERBUBBLE_LIST& superBubblesList = ws.found;
+    int64_t numFound = superBubblesList.size();
+    // A single sweep over the entrances u', with the ids of the DAG computed from the offset (no checked call per entrance).
+    int64_t offset = sg->getOffset();
+    int64_t dumyTerminal = dag->getTerminalId();
+    // s is entrance of a 'real' superbubble:
+    //  - <s', t''> is a superbubble and t is ancesstor of s, or
+    //  - <s', t'> and <s'', t''> are both superbubbles.
+    // (t >= offset means t'': r' is excluded and r cannot be an exit)
+    auto isReported = [&](int64_t s) {
+      if (s >= offset) { // we will only consider u' and not u'' or r' or r''
+	return false;
+      }
+      int64_t t = superBubblesArray->get(s);
+      if (t == -1 || t == dumyTerminal) {
+	return false;
+      }
+      if (t >= offset) { // (local-id 0 is never taken as a descendant, as in the original check)
+	return (s != 0 && sg->isAncestor(t - offset, s));
+      }
+      return (superBubblesArray->get(s + offset) == t + offset);
+    };
+    for (int64_t s=0; s < offset; ++s) {
+      if (isReported(s)) {
+	int64_t t = superBubblesArray->get(s);
+	int64_t realT = (t >= offset) ? t - offset : t;
+	int64_t parent = -1;
+	if (parents != nullptr) { // (parent of <s', t'> or <s', t''> has an entrance u')
+	  parent = reportedParent(parents, superBubblesArray, s, isReported);
+	  parent = (parent == -1) ? -1 : sg->getGlobalId(parent);
+	}
+	superBubblesList.push_back(SuperBubble{sg->getGlobalId(s), sg->getGlobalId(realT), 0, 0, parent});
+	if (interior) {
+	  reportInterior(dag, sg, true, intervals[s], edgePrefix, superBubblesList.back(), ws.interior);
 	}
-	
       }
+    }
 
-      // clean-up
-      delete sg;
-      delete[] superBubblesArray;
-    }    
-  }
+    memoryChanged(MEM_RESULTS, RESULT_BYTES * (int64_t(superBubblesList.size()) - numFound));
 
- //////////////////////// private //////////////////////// 
+    // clean-up
+    sg->releaseAncestorIndex();
+    if (interior) {
+      delete[] intervals;
+      delete[] edgePrefix;
+      memoryChanged(MEM_DAG, -int64_t(sizeof(BubbleInterval) * dag->numVertices() + sizeof(int64_t) * (dag->numVertices() + 1)));
+    }
+    if (parents != nullptr) {
+      delete[] parents;
+      memoryChanged(MEM_DAG, -int64_t(sizeof(BubbleParent)) * dag->numVertices());
+    }
+  }
 
   void 
-  DetectSuperBubble::superBubble(DAG* dag, int64_t* superBubblesArray){ 
+  DetectSuperBubble::superBubble(DAG* dag, Workspace& ws, EpochArray* superBubblesArray, BubbleInterval* intervals, BubbleParent* parents){ 
     /* mark is used by reportSuperBubble() to keep track of the 
      * entrance candidates which have already been checked prior 
      * to the current exit position being considered. 
      * It allows to avoid checking the same path of entrance 
      * candidates repeatedly 
      */
-    int64_t* mark = new int64_t[dag->numVertices()];
-    std::fill_n(mark,dag->numVertices(), 0); // set to 0
+    EpochArray* mark = &ws.marks;
+    mark->reset(dag->numVertices()); // set to -1 (0 is a valid vertex-id)
     
-    dag->prepareForSupBub();
+    dag->prepareForSupBub(_options.relabel, _options.blockRmq);
 
-    while (!dag->candidates.empty()) {
-      if (dag->candidates.tail()->isEntrance) {
-	dag->candidates.delete_tail();
+    std::vector<int64_t> cuts;
+    if (_workspaces.size() > 1) {
+      dag->cutOrders(DAG_CHUNK_VERTICES, cuts);
+    }
+    if (! cuts.empty()) {
+      // one list of candidates per chunk, split before the entrance candidate of each cut vertex (from the last one: each candidate is walked once)
+      std::vector<CandidateList> chunks(cuts.size());
+      for (int64_t i = int64_t(cuts.size()) - 1; i >= 0; --i) {
+	dag->candidates.splitBefore(dag->previousEntrance(dag->vertexAtOrder(cuts[i])), chunks[i]);
+      }
+      // the chunks share the arrays of results and marks: the entrances of two chunks differ
+      for (int64_t i = 0; i <= int64_t(chunks.size()); ++i) {
+	CandidateList* candidates = (i == 0) ? &dag->candidates : &chunks[i - 1];
+#pragma omp task
+	{
+	  std::vector<NestedSearch> nestedSearches;
+	  processCandidates(dag, *candidates, nestedSearches, mark, superBubblesArray, intervals, parents);
+	  int64_t nestedSearchesBytes = sizeof(NestedSearch) * nestedSearches.capacity();
+	  memoryChanged(MEM_CANDIDATES, nestedSearchesBytes);
+	  candidates->updateTrackedMemory();
+	  memoryChanged(MEM_CANDIDATES, -nestedSearchesBytes);
+	}
+      }
+#pragma omp taskwait
+      return;
+    }
+
+    processCandidates(dag, dag->candidates, ws.nestedSearches, mark, superBubblesArray, intervals, parents);
+    int64_t nestedSearchesBytes = sizeof(NestedSearch) * ws.nestedSearches.capacity();
+    memoryChanged(MEM_CANDIDATES, nestedSearchesBytes - ws.nestedSearchesBytes);
+    ws.nestedSearchesBytes = nestedSearchesBytes;
+    dag->candidates.updateTrackedMemory();
+  }
+
+  void
+  DetectSuperBubble::processCandidates(DAG* dag, CandidateList& candidates, std::vector<NestedSearch>& nestedSearches, EpochArray* mark, EpochArray* superBubblesArray, BubbleInterval* intervals, BubbleParent* parents){
+    while (!candidates.empty()) {
+      if (candidates.tail()->isEntrance) {
+	candidates.delete_tail();
       }
       else {
-	reportSuperBubble(dag, mark, dag->candidates.front(), dag->candidates.tail(), superBubblesArray);
+	reportSuperBubble(dag, candidates, nestedSearches, mark, candidates.front(), candidates.tail(), superBubblesArray, intervals, parents);
       }
     }
-    delete[] mark;
   }
  
 
   void 
-  DetectSuperBubble::reportSuperBubble(DAG* dag, int64_t* mark, Candidate* start, Candidate* exit, int64_t* superBubblesArray){
+  DetectSuperBubble::reportSuperBubble(DAG* dag, CandidateList& candidates, std::vector<NestedSearch>& nestedSearches, EpochArray* mark, Candidate* start, Candidate* exit, EpochArray* superBubblesArray, BubbleInterval* intervals, BubbleParent* parents){
+    Candidate* s = reportOneSuperBubble(dag, candidates, mark, start, exit, superBubblesArray, intervals, parents, BubbleParent{-1, -1});
+    if (s == nullptr) {
+      return;
+    }
+    nestedSearches.clear();
+    nestedSearches.push_back(NestedSearch{s, BubbleParent{dag->originalId(s->vertexId), superBubblesArray->get(dag->originalId(s->vertexId))}});
+
+    while (!nestedSearches.empty()) {
+      NestedSearch search = nestedSearches.back(); // (copied: pushing may move the stack)
+      Candidate* nextCand = candidates.tail();
+      if (nextCand == search.entrance) { // no more candidates within the superbubble
+	nestedSearches.pop_back();
+      }
+      else if (! nextCand->isEntrance){  // candidate is an exit candidate
+	// check for nested superbubbles
+	s = reportOneSuperBubble(dag, candidates, mark, search.entrance->next, nextCand, superBubblesArray, intervals, parents, search.bubble);
+	if (s != nullptr) { // search within the nested superbubble first
+	  nestedSearches.push_back(NestedSearch{s, BubbleParent{dag->originalId(s->vertexId), superBubblesArray->get(dag->originalId(s->vertexId))}});
+	}
+      }
+      else {  // entrance candidate
+	candidates.delete_tail(); 
+      }
+    }
+  }
+
+  Candidate*
+  DetectSuperBubble::reportOneSuperBubble(DAG* dag, CandidateList& candidates, EpochArray* mark, Candidate* start, Candidate* exit, EpochArray* superBubblesArray, BubbleInterval* intervals, BubbleParent* parents, BubbleParent parent){
     // sanity check
-    if (start == nullptr || exit == nullptr || dag->ordD[start->vertexId] >= dag->ordD[exit->vertexId]){ 
-      dag->candidates.delete_tail();
-      return; 
+    if (start == nullptr || exit == nullptr || dag->order(start->vertexId) >= dag->order(exit->vertexId)){ 
+      candidates.delete_tail();
+      return nullptr; 
     }
     // Here previous entrance of exit candidate is used
     Candidate* s = exit->pvsEntrance;
     Candidate* valid = nullptr;
-    while(dag->ordD[s->vertexId] >= dag->ordD[start->vertexId]){
+    while(dag->order(s->vertexId) >= dag->order(start->vertexId)){
       valid = validateSuperBubble(dag, s, exit);
-      if (valid==s || valid == nullptr || valid->vertexId == mark[s->vertexId]){
+      if (valid==s || valid == nullptr || valid->vertexId == mark->get(s->vertexId)){
 	break;
       }
-      mark[s->vertexId] = valid->vertexId;
+      mark->set(s->vertexId, valid->vertexId);
       s = valid;
     }
 
     int64_t exitVer = exit->vertexId;
-    dag->candidates.delete_tail(); 
-
-    if (valid == s) {  // superbubble found
-      // report superbubble
-      superBubblesArray[s->vertexId] = exitVer;
-      
-      Candidate* nextCand = dag->candidates.tail();
-      while (nextCand != s){ 
-	if (! nextCand->isEntrance){  // candidate is an exit candidate
-	  // check for nested superbubbles
-	  reportSuperBubble(dag, mark, s->next, nextCand, superBubblesArray);
-	}
-	else {  // entrance candidate
-	  dag->candidates.delete_tail(); 
-	}
-	nextCand = dag->candidates.tail();
-      }
+    candidates.delete_tail(); 
+
+    // (an alternative entrance before start is not validated: it would begin outside of the superbubble within which the search is done)
+    if (valid != s || dag->order(s->vertexId) < dag->order(start->vertexId)) {
+      return nullptr;
+    }
+    // superbubble found: report superbubble
+    BubbleParent found{dag->originalId(s->vertexId), dag->originalId(exitVer)};
+    superBubblesArray->set(found.entrance, found.exit);
+    if (intervals != nullptr) {
+      intervals[found.entrance] = BubbleInterval{dag->order(s->vertexId), dag->order(exitVer)};
+    }
+    // nested superbubbles are found within the enclosing one only;
+    // if it has the same entrance, it is replaced (and its parent is kept)
+    if (parents != nullptr && parent.entrance != found.entrance) {
+      parents[found.entrance] = parent;
     }
+    return s;
   }
 
   Candidate*
   DetectSuperBubble::validateSuperBubble(DAG* dag, Candidate* startCand, 
 					 Candidate* endCand){
-    int64_t start = dag->ordD[startCand->vertexId];
-    int64_t end = dag->ordD[endCand->vertexId];
+    int64_t start = dag->order(startCand->vertexId);
+    int64_t end = dag->order(endCand->vertexId);
     int64_t outChild = dag->rangeMaxOutChild(start, end-1);
     int64_t outParent = dag->rangeMinOutParent(start+1, end);
    
     if (outChild != end){
-      log("returning null for : ", startCand->vertexId, endCand->vertexId);
+      countDiagnostic(DIAG_INVALID_EXIT);
       return nullptr;
     } 
     if (outParent == start) {
@@ -26,6 +26,11 @@
 #include "Subgraph.hpp"
 #include "DAG.hpp"
 #include "CandidateList.hpp"
+#include "EpochArray.hpp"
+#include "PartitionSpill.hpp"
+#include "VertexNames.hpp"
+
+#include <sstream>
 
 namespace supbub{
 
@@ -52,23 +57,240 @@ namespace supbub{
     struct SuperBubble{
       int64_t entrance; // id of entrance vertex
       int64_t exit; // id of exit vertex
+      int64_t numVertices; // number of vertices, entrance and exit included (only with option interiorSizes, 0 otherwise)
+      int64_t numEdges; // number of edges between its vertices (only with option interiorSizes, 0 otherwise)
+      int64_t parent; // id of entrance vertex of the smallest superbubble containing it, -1 if none (only with option hierarchy, -1 otherwise)
     };
 
     /** type for list of superbubbles */
     typedef std::list<SuperBubble> SUPERBUBBLE_LIST;
 
+    /** struct for the options controlling the detection */
+    struct Options{
+      bool relabel; // renumber the vertices of each DAG in topological order before detection
+      bool blockRmq; // answer rmq with BlockRMQ instead of the succinct rmq of sdsl
+      bool interiorSizes; // fill in numVertices and numEdges of each superbubble
+      std::ostream* interiorVertices; // if not null, the vertices of each superbubble are written to it as found (one superbubble per line)
+      const int64_t* originalIds; // if not null, the ids written to interiorVertices are translated: originalIds[v] is written for vertex v of the graph
+      const VertexNames* vertexNames; // if not null, the names of the vertices are written to interiorVertices instead of their ids
+      bool hierarchy; // fill in parent of each superbubble
+      int numThreads; // number of threads processing subgraphs concurrently
+      bool unordered; // give the superbubbles in the order in which the threads find them instead of sorted by entrance
+    };
+
+    /** Constructor (default options) */
+    DetectSuperBubble();
+
+    /** Constructor
+     * @param options options controlling the detection.
+     */
+    DetectSuperBubble(Options options);
+
+    /** Destructor */
+    ~DetectSuperBubble();
+
     /** Finds superbubbles in the given graph.
      *
      * See paper-1 to understand its functioning.
      *
+     * Subgraphs are processed by options.numThreads threads. Unless options.unordered, the superbubbles (and the lines of options.interiorVertices) are given sorted by entrance, whatever the number of threads.
+     *
      * @param g reference to the graph in which superbubbles are to be found.
      * @param superBubblesList reference to list of superbubbles in which result is to be returned.
      */
     void find(Graph& g, SUPERBUBBLE_LIST& superBubblesList);
 
+    /** Partitions the given graph into subgraphs (stage 1 of find) and writes them to disk instead of keeping them in memory.
+     *
+     * Used when the graph and all of its subgraphs do not fit in memory together: once the subgraphs are written, the graph may be released before calling findFromDisk().
+     *
+     * @param g reference to the graph in which superbubbles are to be found.
+     * @param spill reference to the (opened) spill in which subgraphs are to be written.
+     * @return true on success, false on a write error.
+     */
+    bool partitionToDisk(Graph& g, PartitionSpill& spill);
+
+    /** Finds superbubbles in the subgraphs written by partitionToDisk() (stages 2 and 3 of find).
+     *
+     * Subgraphs are read and processed one at a time by each thread, so only one of them per thread is in memory at a time. The results are ordered as by find().
+     *
+     * @param spill reference to the spill in which subgraphs have been written.
+     * @param superBubblesList reference to list of superbubbles in which result is to be returned.
+     * @return true on success, false on a read error.
+     */
+    bool findFromDisk(PartitionSpill& spill, SUPERBUBBLE_LIST& superBubblesList);
+
+    /** Gives the part of each vertex of the given graph: the parts are the non-singleton sccs and the weakly connected components of the singletons.
+     *
+     * No superbubble spans two parts, and the superbubbles of a part depend only on its vertices and the edges incident to them: after the graph is changed, those of the parts left as they were (same vertices, none of them an end of a changed edge) are the same, and only the other parts need to be processed again (findInParts()).
+     *
+     * @param g reference to the graph.
+     * @param part pointer to the array (an entry per vertex) in which the part of each vertex is to be returned: the smallest vertex of its part for a singleton, -1 - the smallest vertex of its scc otherwise.
+     */
+    void findParts(Graph& g, int64_t* part);
+
+    /** Gives the smallest vertex of a part (as given by findParts()). */
+    static int64_t smallestOfPart(int64_t part) { return (part >= 0) ? part : -1 - part; }
+
+    /** Finds the superbubbles in some parts of the given graph (stages 2 and 3 of find on these parts only).
+     * @param g reference to the graph.
+     * @param part pointer to the parts of the vertices (see findParts()).
+     * @param selected pointer to the array telling whether the part of each vertex is to be processed (all the vertices of a part must have the same value), or nullptr for all of them.
+     * @param superBubblesList reference to list of superbubbles in which result is to be returned (ordered as by find()).
+     */
+    void findInParts(Graph& g, const int64_t* part, const bool* selected, SUPERBUBBLE_LIST& superBubblesList);
+
     //////////////////////// private ////////////////////////
   private:
 
+    /** type for the vertices of a graph grouped by subgraph (see partitionVertices) */
+    struct Partition{
+      int64_t numSubgraphs;         // number of subgraphs
+      int64_t numVertices;          // number of vertices of the graph
+      int64_t numAcyclic;           // number of subgraphs of singletons (the first ones, each a batch of weakly connected components)
+      int64_t* scc;                 // scc[v] = id of the subgraph of vertex v, -1 if it belongs to none (part not selected)
+      int64_t* globalToLocalIdMap;  // local-id of each vertex in its subgraph
+      int64_t* firstOfSubgraph;     // position in verticesBySubgraph of the first vertex of each subgraph (numSubgraphs + 1 entries)
+      int64_t* verticesBySubgraph;  // vertices grouped by subgraph, each group in the order of local-ids
+    };
+
+    /** Finds the sccs of the given graph and groups its vertices by subgraph (stage 1 without building the subgraphs).
+     * @param g reference to the (finalized) graph.
+     * @param partition reference to the partition to be filled in (to be released with releasePartition).
+     */
+    void partitionVertices(Graph& g, Partition& partition);
+
+    /** Allocates the arrays of a partition which have an entry per vertex. */
+    void allocatePartition(Partition& partition, int64_t numVertices);
+
+    /** Groups the vertices of the selected parts by subgraph: the weakly connected components of singletons in batches, then the non-singleton sccs.
+     * @param partition reference to the partition (allocated), whose scc array holds the parts of the vertices (see findParts()) and is overwritten.
+     * @param selected pointer to the array telling whether the part of each vertex is to be processed, or nullptr for all of them.
+     */
+    void groupVertices(Partition& partition, const bool* selected);
+
+    /** Releases the arrays of a partition. */
+    void releasePartition(Partition& partition);
+
+    /** Builds one subgraph of a partition (see PartitionGraph in paper-1).
+     * @param g reference to the graph.
+     * @param partition reference to the partition of the graph.
+     * @param sg id of the subgraph.
+     * @return pointer to a new finalized subgraph (to be deleted by the caller).
+     */
+    Subgraph* buildSubgraph(Graph& g, Partition& partition, int64_t sg);
+
+    /** type for the topological interval of a superbubble in its DAG: the vertices of the superbubble are exactly the vertices with order in [first, last] */
+    struct BubbleInterval{
+      int64_t first; // order of the entrance
+      int64_t last;  // order of the exit
+    };
+
+    /** type for the parent of a superbubble: the superbubble within which it is found (original ids in the DAG, entrance -1 if none).
+     * The parent may be replaced later by a smaller superbubble with the same entrance (found nested in it): the link is then valid no more (the exit differs) and the parent of the replaced superbubble is to be taken (it is kept at the entrance).
+     */
+    struct BubbleParent{
+      int64_t entrance; // entrance of the parent
+      int64_t exit;     // exit of the parent
+    };
+
+    /** type for a superbubble within which nested superbubbles are being searched (see reportSuperBubble) */
+    struct NestedSearch{
+      Candidate* entrance; // entrance candidate of the superbubble (the search ends when it is the tail of the list again)
+      BubbleParent bubble; // the superbubble (parent of the nested ones)
+    };
+
+    /** type for the structures used by one thread: scratch arrays kept from one DAG to the next, and the results of the subgraphs it has processed */
+    struct Workspace{
+      EpochArray superBubbles;                  // superbubbles found in a DAG (reset in constant time from one DAG to the next)
+      EpochArray marks;                         // marks of reportSuperBubble
+      std::vector<NestedSearch> nestedSearches; // stack of the nested searches of reportSuperBubble (kept with its capacity)
+      int64_t nestedSearchesBytes;              // bytes accounted for the capacity of nestedSearches
+      SUPERBUBBLE_LIST found;                   // superbubbles found, subgraph after subgraph
+      std::ostringstream interior;              // lines of options.interiorVertices not yet written, in the same order
+
+      Workspace() : superBubbles(-1, MEM_DAG), marks(-1, MEM_DAG), nestedSearchesBytes(0) {}
+    };
+
+    /** type for the superbubbles found in one subgraph: they are consecutive in the list of the thread which processed it and sorted by entrance (local-ids are given in the order of global-ids) */
+    struct Run{
+      int worker;                       // index of the workspace of the thread
+      SUPERBUBBLE_LIST::iterator first; // first superbubble of the run
+      int64_t size;                     // number of superbubbles
+      int64_t interiorOffset;           // position of the line of the first one in the interior text of the workspace
+    };
+
+    /** Finds superbubbles in the given subgraphs, processed concurrently, and gives them in the order required by the options (stages 2 and 3 of find).
+     * @param numSubgraphs number of subgraphs.
+     * @param numAcyclic number of subgraphs of singletons (the first ones).
+     * @param getSubgraph function giving subgraph i (a new finalized subgraph, deleted here), or nullptr on an error; it is called from several threads.
+     * @param superBubblesList reference to list of superbubbles in which result is to be returned.
+     * @return true on success, false if getSubgraph failed.
+     */
+    template<class GET_SUBGRAPH>
+    bool findInSubgraphs(int64_t numSubgraphs, int64_t numAcyclic, GET_SUBGRAPH getSubgraph, SUPERBUBBLE_LIST& superBubblesList);
+
+    /** Moves the runs to the list of results by a k-way merge on their entrances (the lines of the interior vertices are written in the same order).
+     * @param runs reference to the runs (indexed by subgraph, consumed).
+     * @param superBubblesList reference to list of superbubbles in which result is to be returned.
+     */
+    void mergeRuns(std::vector<Run>& runs, SUPERBUBBLE_LIST& superBubblesList);
+
+    /** Writes the buffered lines of interior vertices of a workspace to options.interiorVertices, if they take at least the given number of bytes.
+     * Safe to call from several threads (the writes are serialized).
+     * @param ws reference to the workspace.
+     * @param minBytes number of bytes below which the lines are kept buffered.
+     */
+    void flushInterior(Workspace& ws, int64_t minBytes);
+
+    /** Fills in the size of a superbubble found in a DAG and writes its vertices (according to the options).
+     * The interval gives them directly (no traversal): the number of vertices is its length and the number of edges is the sum of the out-degrees of the vertices in it but the exit (all their children are in the interval).
+     * @param dag pointer to the DAG (prepared for detection) in which the superbubble was found.
+     * @param sg pointer to the subgraph of the DAG.
+     * @param cyclic true if the DAG was obtained by converting sg (ids of duplicates u'' are then mapped to u).
+     * @param interval reference to the interval of the superbubble.
+     * @param edgePrefix pointer to the array of prefix sums of out-degrees in topological order (see edgePrefixSums).
+     * @param bubble reference to the superbubble (already holding the global ids of entrance and exit).
+     * @param out reference to the stream to which its vertices are written (with option interiorVertices).
+     */
+    void reportInterior(DAG* dag, Subgraph* sg, bool cyclic, const BubbleInterval& interval, const int64_t* edgePrefix, SuperBubble& bubble, std::ostream& out);
+
+    /** Writes a vertex of the graph as it was given in the input: its name (option vertexNames), its original id (option originalIds) or its id.
+     * @param out reference to the stream.
+     * @param v global id of the vertex.
+     */
+    void writeVertex(std::ostream& out, int64_t v);
+
+    /** Returns the array of prefix sums of out-degrees in topological order: entry o is the number of edges out of the vertices with order less than o.
+     * @param dag pointer to the DAG (prepared for detection).
+     * @return pointer to a new array of (number of vertices + 1) elements (to be deleted by the caller).
+     */
+    int64_t* edgePrefixSums(DAG* dag);
+
+    /** Gives the parent of a superbubble among the reported ones, skipping the enclosing superbubbles which are replaced or not reported (e.g. 'unreal' ones).
+     * The chains of skipped superbubbles are shortened on the way, so that each of them is walked through only once.
+     * @param parents pointer to the array of parents filled in by superBubble() (entries of skipped superbubbles are updated).
+     * @param superBubblesArray pointer to the array of superbubbles filled in by superBubble().
+     * @param s id of entrance vertex (in the DAG) of the superbubble.
+     * @param isReported function telling whether the superbubble starting at a given vertex is reported.
+     * @return id of entrance vertex (in the DAG) of the parent, -1 if none.
+     */
+    template<class IS_REPORTED>
+    int64_t reportedParent(BubbleParent* parents, EpochArray* superBubblesArray, int64_t s, IS_REPORTED isReported);
+
+    /** Finds superbubbles in a subgraph of singletons (which is already acyclic) and adds them to the list.
+     * @param sg0 pointer to the subgraph.
+     * @param ws reference to the workspace of the thread (the superbubbles are added to ws.found).
+     */
+    void findInAcyclic(Subgraph* sg0, Workspace& ws);
+
+    /** Finds superbubbles in a subgraph corresponding to a non-singleton scc and adds the 'real' ones to the list.
+     * The subgraph is converted into acyclic (G') and 'unreal' superbubbles are filtered out.
+     * @param sg pointer to the subgraph.
+     * @param ws reference to the workspace of the thread (the superbubbles are added to ws.found).
+     */
+    void findInCyclic(Subgraph* sg, Workspace& ws);
+
     /** Finds superbubbles in the given graph.
      *
      * See paper-2 to understand its functioning. Only variation is from the paper is the format in which superbubbles are being reported. It does not return a list of struct superbubbles but superbubbles are reported as an array superBubblesArray. (It was necessary for filtering out 'unreal' superbubbles later.)
@@ -78,27 +300,68 @@ namespace supbub{
      *   superBubblesArray[x] = -1 => No superbubble starts at x.
      *
      * After the graph is preprocessed, SuperBubble processes the candidates-list of the graph in decreasing topological order (backwards).
+     * With more than one thread, a large DAG is cut at the vertices through which every path goes (see DAG::cutOrders()): no superbubble spans a cut vertex, and no search of the algorithm goes past one, so the candidates between two cuts are processed as tasks of their own (run by the threads which are idle) with the same result.
      *
      * @param dag pointer to the DAG in which superbubbles are to be found.
+     * @param ws reference to the workspace of the thread (its marks and stack of nested searches are used).
      * @param superBubblesArray pointer to the array of superbubbles in which result is to be returned.
+     * @param intervals pointer to the array in which the interval of each superbubble is to be returned (indexed like superBubblesArray), or nullptr.
+     * @param parents pointer to the array in which the entrance of the parent of each superbubble (the nearest superbubble within which it is found) is to be returned (indexed like superBubblesArray, -1 if none), or nullptr.
      */
     void 
-    superBubble(DAG* dag, int64_t* superBubblesArray);
+    superBubble(DAG* dag, Workspace& ws, EpochArray* superBubblesArray, BubbleInterval* intervals, BubbleParent* parents);
+
+    /** Processes the given candidates (a list of consecutive candidates of the DAG, beginning with an entrance candidate through which every path goes, or the whole list) from the tail until none is left.
+     *
+     * Helper of superBubble (the loop of algorithm SuperBubble).
+     * @param dag pointer to the DAG in which superbubbles are to be found.
+     * @param candidates reference to the list of candidates (emptied).
+     * @param nestedSearches reference to the stack of nested searches to be used.
+     * @param mark pointer to the array marking the entrance candidates which have already been checked (see reportSuperBubble).
+     * @param superBubblesArray pointer to the array of superbubbles in which result is to be returned.
+     * @param intervals pointer to the array in which the interval of each superbubble is to be returned, or nullptr.
+     * @param parents pointer to the array in which the parent of each superbubble is to be returned, or nullptr.
+     */
+    void
+    processCandidates(DAG* dag, CandidateList& candidates, std::vector<NestedSearch>& nestedSearches, EpochArray* mark, EpochArray* superBubblesArray, BubbleInterval* intervals, BubbleParent* parents);
     
     /** Reports the superbubbles ending at the given exit candidate along with the nested superbubbles between the given entrance and exit candidates.
      *
      * See paper-2 to understand its functioning. Helper of superBubble.
      *
-     * Checks the possible entrance candidates between start and exit starting with the nearest previous entrance candidate (to exit).
-     * It is called for each exit candidate in a reverse order(of candidate list) either by algorithm SuperBubble or through a recursive call to identify a nested superbubble.
+     * It is called for each exit candidate in a reverse order(of candidate list) by algorithm SuperBubble.
+     * The nested superbubbles are searched without recursion (which would go as deep as the nesting): the superbubbles within which the search goes on are kept on an explicit stack (nestedSearches), the innermost on top.
      * @param dag pointer to the DAG in which superbubbles are to be found.
+     * @param candidates reference to the list of candidates being processed.
+     * @param nestedSearches reference to the stack of nested searches.
      * @param mark pointer to the array marking the entrance candidates which have already been checked prior to the current exit position being considered. It allows to avoid checking the same path of entrance candidates repeatedly.
      * @param start pointer to start candidate.
      * @param exit pointer to exit candidate. 
      * @param superBubblesArray pointer to the array of superbubbles in which result is to be returned.
+     * @param intervals pointer to the array in which the interval of each superbubble is to be returned, or nullptr.
+     * @param parents pointer to the array in which the parent of each superbubble is to be returned, or nullptr.
      */
      void 
-     reportSuperBubble(DAG* dag, int64_t* mark, Candidate* start, Candidate* exit, int64_t* superBubblesArray);
+     reportSuperBubble(DAG* dag, CandidateList& candidates, std::vector<NestedSearch>& nestedSearches, EpochArray* mark, Candidate* start, Candidate* exit, EpochArray* superBubblesArray, BubbleInterval* intervals, BubbleParent* parents);
+
+    /** Reports the superbubble ending at the given exit candidate, if any (nested superbubbles are not searched).
+     *
+     * Helper of reportSuperBubble (one step of the search).
+     *
+     * Checks the possible entrance candidates between start and exit starting with the nearest previous entrance candidate (to exit). The exit candidate is removed from the list.
+     * @param dag pointer to the DAG in which superbubbles are to be found.
+     * @param candidates reference to the list of candidates being processed (exit is its tail).
+     * @param mark pointer to the array marking the entrance candidates which have already been checked.
+     * @param start pointer to start candidate.
+     * @param exit pointer to exit candidate. 
+     * @param superBubblesArray pointer to the array of superbubbles in which result is to be returned.
+     * @param intervals pointer to the array in which the interval of each superbubble is to be returned, or nullptr.
+     * @param parents pointer to the array in which the parent of each superbubble is to be returned, or nullptr.
+     * @param parent superbubble within which the search is done (entrance -1 at the top level).
+     * @return pointer to the entrance candidate of the superbubble found, nullptr if none.
+     */
+     Candidate*
+     reportOneSuperBubble(DAG* dag, CandidateList& candidates, EpochArray* mark, Candidate* start, Candidate* exit, EpochArray* superBubblesArray, BubbleInterval* intervals, BubbleParent* parents, BubbleParent parent);
 
     /** Validates the superbubbles starting and ending at the vertices corresponding to the given entrance and exit candidates.If not returns the alternative entrance candidate.
      *
@@ -114,6 +377,15 @@ namespace supbub{
      Candidate*
       validateSuperBubble(DAG* dag, Candidate* startCand, Candidate* endCand);
 
+    /** options controlling the detection */
+    Options _options;
+
+    /** workspaces of the threads (one per thread) */
+    std::vector<Workspace*> _workspaces;
+
+    /** Creates the workspaces (constructor helper). */
+    void initWorkspaces();
+
   };
 
 } // end namespace
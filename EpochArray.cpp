@@ -0,0 +1,59 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class EpochArray
+ */
+#include "EpochArray.hpp"
+
+namespace supbub{
+
+  EpochArray::EpochArray(int64_t defaultValue, MemComponent component) {
+    _values = nullptr;
+    _stamps = nullptr;
+    _epoch = 1;
+    _defaultValue = defaultValue;
+    _size = 0;
+    _capacity = 0;
+    _memComponent = component;
+  }
+
+  EpochArray::~EpochArray() {
+    delete[] _values;
+    delete[] _stamps;
+    memoryChanged(_memComponent, -int64_t(sizeof(int64_t) + sizeof(uint32_t)) * _capacity);
+  }
+
+  void
+  EpochArray::reset(int64_t size){
+    _size = size;
+    if (size > _capacity) { // grow: new arrays, all entries stamped 0 (never written)
+      delete[] _values;
+      delete[] _stamps;
+      _values = new int64_t[size];
+      _stamps = new uint32_t[size];
+      std::fill_n(_stamps, size, 0);
+      memoryChanged(_memComponent, int64_t(sizeof(int64_t) + sizeof(uint32_t)) * (size - _capacity));
+      _capacity = size;
+      _epoch = 1;
+      return;
+    }
+    _epoch++;
+    if (_epoch == 0) { // wrapped around: entries of old epochs could be taken for current ones
+      std::fill_n(_stamps, _capacity, 0);
+      _epoch = 1;
+    }
+  }
+
+} // end namespace
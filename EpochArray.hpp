@@ -0,0 +1,93 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class EpochArray.
+ * It is a scratch array of integers which is reset in constant time, so that it can be reused from one DAG to the next.
+ */
+
+#ifndef EPOCH_ARRAY_HPP
+#define EPOCH_ARRAY_HPP
+
+#include "globalDefs.hpp"
+#include "MemoryStats.hpp"
+
+namespace supbub{
+
+  /** Class EpochArray
+   * Each entry holds a value and the epoch (generation) at which it was written.
+   * An entry written before the current epoch reads as the default value, so that resetting the whole array only increments the epoch.
+   * The arrays only grow: they are reallocated when a larger size is asked for, and then kept for the next uses.
+   * The epoch is 32 bits wide: when it wraps around, the stamps are cleared (once every 2^32 - 1 resets).
+   *
+   * This class provides for the following:
+   *  - Resetting the array to a given size (all entries set to the default value).
+   *  - Reading and writing an entry.
+   */
+
+  class EpochArray{
+
+  public:
+
+    /** Constructor (empty array)
+     * @param defaultValue value of the entries not written since the last reset.
+     * @param component component to which the memory of the array is accounted.
+     */
+    EpochArray(int64_t defaultValue, MemComponent component);
+
+    /** Destructor */
+    ~EpochArray();
+
+    /** Sets the size of the array and sets all of its entries to the default value.
+     * Takes constant time unless the array has to grow.
+     * @param size number of entries.
+     */
+    void reset(int64_t size);
+
+    /** Gives the number of entries (since the last reset). */
+    int64_t size() { return _size; }
+
+    /** Returns the value of the given entry. Assumes 0 <= i < size(). */
+    int64_t get(int64_t i) { return (_stamps[i] == _epoch) ? _values[i] : _defaultValue; }
+
+    /** Sets the value of the given entry. Assumes 0 <= i < size(). */
+    void set(int64_t i, int64_t value) { _values[i] = value; _stamps[i] = _epoch; }
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** values of the entries (meaningful only where the stamp is the current epoch) */
+    int64_t* _values;
+
+    /** epoch at which each entry was written last */
+    uint32_t* _stamps;
+
+    /** current epoch (never 0, which is the stamp of entries never written) */
+    uint32_t _epoch;
+
+    /** value of the entries not written since the last reset */
+    int64_t _defaultValue;
+
+    /** number of entries since the last reset */
+    int64_t _size;
+
+    /** number of entries allocated */
+    int64_t _capacity;
+
+    /** component to which the memory is accounted */
+    MemComponent _memComponent;
+  };
+
+} // end namespace
+#endif
@@ -17,16 +17,29 @@
  */
 #include "Graph.hpp"
 
+#include <omp.h>
+
 namespace supbub {
 
-  Graph::Graph(int64_t n) {
+  Graph::Graph(int64_t n): Graph(n, MEM_GRAPH) {
+  }
+
+  Graph::Graph(int64_t n, MemComponent component): Graph(n, component, true) {
+  }
+
+  Graph::Graph(int64_t n, MemComponent component, bool adjacency) {
     _numVertices = n;
     _numEdges = 0;
-    _adjList = new int64_t_LIST[n];
-    std::fill_n(_adjList, _numVertices, int64_t_LIST{}); // set to empty list
-
-   _parentList = new int64_t_LIST[_numVertices];
-   std::fill_n(_parentList, _numVertices, int64_t_LIST{}); // set to empty list
+    _adjList.start = nullptr;
+    _adjList.ids = nullptr;
+    _parentList.start = nullptr;
+    _parentList.ids = nullptr;
+    if (adjacency) {
+      _adjList.start = new int64_t[_numVertices + 1];
+      std::fill_n(_adjList.start, _numVertices + 1, 0); // set to empty list
+      _parentList.start = new int64_t[_numVertices + 1];
+      std::fill_n(_parentList.start, _numVertices + 1, 0); // set to empty list
+    }
 
 
     _inDegree = new int64_t[_numVertices];
@@ -35,71 +48,261 @@ namespace supbub {
     _outDegree = new int64_t[_numVertices];
     std::fill_n(_outDegree, _numVertices, 0); // set to 0
 
+    _memComponent = component;
+    _trackedBytes = 0;
+    updateTrackedMemory();
    }
 
   Graph::~Graph() {
-    delete[] _adjList;
-    delete[] _parentList;
+    delete[] _adjList.start;
+    delete[] _adjList.ids;
+    delete[] _parentList.start;
+    delete[] _parentList.ids;
     delete[] _inDegree;
     delete[] _outDegree;
+    memoryChanged(_memComponent, -_trackedBytes);
   }
 
-  int64_t 
-  Graph::numVertices(){
-    return _numVertices;
+  void 
+  Graph::addEdge(int64_t u, int64_t v){
+#if SUPBUB_CHECKED
+    if (u >= _numVertices || v >= _numVertices || u < 0 || v < 0) {
+      invalidId("Invalid u : ", u);
+      invalidId("Invalid v : ", v);
+      return;
+    }
+#endif
+    bool grows = (_pendingTail.size() == _pendingTail.capacity());
+    _pendingTail.push_back(u);
+    _pendingHead.push_back(v);
+    if (grows) {
+      updateTrackedMemory();
+    }
+    _numEdges++;
+    _inDegree[v]++;
+    _outDegree[u]++;
   }
 
-  int64_t 
-  Graph::numEdges(){
-    return _numEdges;
+  void
+  Graph::reserveEdges(int64_t m){
+    _pendingTail.reserve(_pendingTail.size() + m);
+    _pendingHead.reserve(_pendingHead.size() + m);
+    updateTrackedMemory();
   }
 
-
-  int64_t_LIST&
-  Graph::getChildren(int64_t v){
-    return  _adjList[v];
+  void
+  Graph::addEdges(std::vector<int64_t>& tails, std::vector<int64_t>& heads){
+    int64_t first = _pendingTail.size();
+    if (first == 0) {
+      _pendingTail.swap(tails);
+      _pendingHead.swap(heads);
+    }
+    else {
+      _pendingTail.insert(_pendingTail.end(), tails.begin(), tails.end());
+      _pendingHead.insert(_pendingHead.end(), heads.begin(), heads.end());
+    }
+    std::vector<int64_t>().swap(tails);
+    std::vector<int64_t>().swap(heads);
+    int64_t numPending = _pendingTail.size();
+    for (int64_t e = first; e < numPending; ++e) {
+      _inDegree[_pendingHead[e]]++;
+      _outDegree[_pendingTail[e]]++;
+    }
+    _numEdges += numPending - first;
+    updateTrackedMemory();
   }
 
+  void
+  Graph::finalize(){
+    if (_pendingTail.empty()) {
+      return;
+    }
+    // Lists grow to the current degrees: copy the old part, then append the pending edges in the order they were added
+    ADJACENCY adjList{new int64_t[_numVertices + 1], new int64_t[_numEdges]};
+    ADJACENCY parentList{new int64_t[_numVertices + 1], new int64_t[_numEdges]};
+    int64_t* adjFill = new int64_t[_numVertices];
+    int64_t* parentFill = new int64_t[_numVertices];
+    int64_t newBytes = sizeof(int64_t) * (4 * _numVertices + 2 + 2 * _numEdges);
+    memoryChanged(_memComponent, newBytes);
+    adjList.start[0] = 0;
+    parentList.start[0] = 0;
+    for (int64_t v = 0; v < _numVertices; ++v) {
+      adjList.start[v+1] = adjList.start[v] + _outDegree[v];
+      parentList.start[v+1] = parentList.start[v] + _inDegree[v];
+      int64_t_LIST children = _adjList[v];
+      std::copy(children.begin(), children.end(), adjList.ids + adjList.start[v]);
+      adjFill[v] = adjList.start[v] + children.size();
+      int64_t_LIST parents = _parentList[v];
+      std::copy(parents.begin(), parents.end(), parentList.ids + parentList.start[v]);
+      parentFill[v] = parentList.start[v] + parents.size();
+    }
+    int64_t numPending = _pendingTail.size();
+    for (int64_t e = 0; e < numPending; ++e) {
+      int64_t u = _pendingTail[e];
+      int64_t v = _pendingHead[e];
+      adjList.ids[adjFill[u]++] = v;
+      parentList.ids[parentFill[v]++] = u;
+    }
 
-  int64_t_LIST&
-  Graph::getParents(int64_t v){
-    return _parentList[v];
+    // clean up
+    delete[] adjFill;
+    delete[] parentFill;
+    delete[] _adjList.start;
+    delete[] _adjList.ids;
+    delete[] _parentList.start;
+    delete[] _parentList.ids;
+    _adjList = adjList;
+    _parentList = parentList;
+    std::vector<int64_t>().swap(_pendingTail);
+    std::vector<int64_t>().swap(_pendingHead);
+    memoryChanged(_memComponent, -newBytes);
+    updateTrackedMemory();
   }
 
-  int64_t
-  Graph::getInDegree(int64_t v){
-    if (v < _numVertices && v >= 0) {
-      return _inDegree[v];
-    } else {
-      log("Invalid v : ", v);
-      return -1;
+
+
+  /* number of bits of the digits of the radix sort of the edges */
+  static const int RADIX_BITS = 11;
+  static const int64_t RADIX = int64_t(1) << RADIX_BITS;
+
+  /* One (stable) pass of the radix sort of the edges tails[e] -> heads[e] on the digit of keys[e] (tails or heads) at the given shift, into outTails and outHeads.
+   * Each thread counts the digits of a block of edges, then moves them to the positions following those of the same digit in the blocks before.
+   * counts has RADIX entries per thread. Returns false (and moves nothing) if all edges have the same digit.
+   */
+  static bool
+  radixPass(const int64_t* keys, const int64_t* tails, const int64_t* heads, int64_t* outTails, int64_t* outHeads, int64_t m, int shift, int numThreads, int64_t* counts){
+    bool moved = true;
+#pragma omp parallel num_threads(numThreads)
+    {
+      int numBlocks = omp_get_num_threads();
+      int block = omp_get_thread_num();
+      int64_t first = m * block / numBlocks;
+      int64_t last = m * (block + 1) / numBlocks;
+      int64_t* count = counts + block * RADIX;
+      std::fill_n(count, RADIX, 0);
+      for (int64_t e = first; e < last; ++e) {
+	count[(keys[e] >> shift) & (RADIX - 1)]++;
+      }
+#pragma omp barrier
+#pragma omp single
+      {
+	int64_t position = 0;
+	for (int64_t d = 0; d < RADIX; ++d) {
+	  int64_t start = position;
+	  for (int b = 0; b < numBlocks; ++b) {
+	    int64_t c = counts[b * RADIX + d];
+	    counts[b * RADIX + d] = position;
+	    position += c;
+	  }
+	  if (position - start == m) {
+	    moved = false;
+	  }
+	}
+      }
+      if (moved) {
+	for (int64_t e = first; e < last; ++e) {
+	  int64_t p = count[(keys[e] >> shift) & (RADIX - 1)]++;
+	  outTails[p] = tails[e];
+	  outHeads[p] = heads[e];
+	}
+      }
     }
+    return moved;
   }
 
   int64_t
-  Graph::getOutDegree(int64_t v){
-    if (v < _numVertices  && v >= 0) {
-      return _outDegree[v];
-    } else {
-      log("Invalid v : ", v);
-      return -1;
+  Graph::finalizeUnique(int numThreads, bool dropSelfLoops){
+    numThreads = std::max(numThreads, 1);
+    int64_t m = _pendingTail.size();
+    int bits = 0;
+    while (bits < 63 && (int64_t(1) << bits) < _numVertices) {
+      ++bits;
     }
-  }
 
+    // Radix sort on (tail, head): digits of the heads first, then of the tails
+    int64_t* tails = _pendingTail.data();
+    int64_t* heads = _pendingHead.data();
+    int64_t* bufferTails = new int64_t[m];
+    int64_t* bufferHeads = new int64_t[m];
+    int64_t* counts = new int64_t[numThreads * RADIX];
+    int64_t sortBytes = sizeof(int64_t) * (2 * m + numThreads * RADIX);
+    memoryChanged(_memComponent, sortBytes);
+    for (int key = 0; key < 2; ++key) {
+      for (int shift = 0; shift < bits; shift += RADIX_BITS) {
+	if (radixPass((key == 0) ? heads : tails, tails, heads, bufferTails, bufferHeads, m, shift, numThreads, counts)) {
+	  std::swap(tails, bufferTails);
+	  std::swap(heads, bufferHeads);
+	}
+      }
+    }
+    delete[] counts;
+    // the arrays not holding the sorted edges are not needed anymore
+    bool inBuffers = (tails != _pendingTail.data());
+    int64_t releasedBytes = sizeof(int64_t) * numThreads * RADIX;
+    if (inBuffers) {
+      std::vector<int64_t>().swap(_pendingTail);
+      std::vector<int64_t>().swap(_pendingHead);
+      updateTrackedMemory();
+    } else {
+      delete[] bufferTails;
+      delete[] bufferHeads;
+      releasedBytes += sizeof(int64_t) * 2 * m;
+    }
+    memoryChanged(_memComponent, -releasedBytes);
+    sortBytes -= releasedBytes;
 
-  void 
-  Graph::addEdge(int64_t u, int64_t v){
-    if (u > _numVertices || v > _numVertices || u < 0 || v < 0) {
-      log("Invalid u or v : ", u, v);
+    // Degrees of the edges kept (a duplicate edge follows the first one)
+    std::fill_n(_outDegree, _numVertices, 0);
+    std::fill_n(_inDegree, _numVertices, 0);
+    auto kept = [&](int64_t e) {
+      return !((e > 0 && tails[e] == tails[e - 1] && heads[e] == heads[e - 1]) || (dropSelfLoops && tails[e] == heads[e]));
+    };
+    _numEdges = 0;
+    for (int64_t e = 0; e < m; ++e) {
+      if (kept(e)) {
+	_outDegree[tails[e]]++;
+	_inDegree[heads[e]]++;
+	_numEdges++;
+      }
     }
-    _adjList[u].push_back(v);
-    _numEdges++;
-    _inDegree[v]++;
-    _outDegree[u]++;
-    _parentList[v].push_back(u);
-  }
 
+    // Both adjacency arrays in one pass: the children of a vertex follow each other, the parents are put after those of the same vertex put before
+    delete[] _adjList.start;
+    delete[] _adjList.ids;
+    delete[] _parentList.start;
+    delete[] _parentList.ids;
+    _adjList = ADJACENCY{new int64_t[_numVertices + 1], new int64_t[_numEdges]};
+    _parentList = ADJACENCY{new int64_t[_numVertices + 1], new int64_t[_numEdges]};
+    updateTrackedMemory();
+    _adjList.start[0] = 0;
+    _parentList.start[0] = 0;
+    for (int64_t v = 0; v < _numVertices; ++v) {
+      _adjList.start[v + 1] = _adjList.start[v] + _outDegree[v];
+      _parentList.start[v + 1] = _parentList.start[v] + _inDegree[v];
+    }
+    int64_t child = 0;
+    for (int64_t e = 0; e < m; ++e) {
+      if (kept(e)) {
+	_adjList.ids[child++] = heads[e];
+	_parentList.ids[_parentList.start[heads[e] + 1] - _inDegree[heads[e]]--] = tails[e];
+      }
+    }
+    for (int64_t v = 0; v < _numVertices; ++v) { // (emptied while filling)
+      _inDegree[v] = _parentList.start[v + 1] - _parentList.start[v];
+    }
 
+    // clean up
+    if (inBuffers) {
+      delete[] tails;
+      delete[] heads;
+      memoryChanged(_memComponent, -sortBytes);
+    } else {
+      std::vector<int64_t>().swap(_pendingTail);
+      std::vector<int64_t>().swap(_pendingHead);
+      updateTrackedMemory();
+    }
+    return m - _numEdges;
+  }
 
   // In accordance with the explanation found on http://www.geeksforgeeks.org/tarjan-algorithm-find-strongly-connected-components/ and wikipedia
   /* Complexity: O(E + V)
@@ -129,6 +332,8 @@ namespace supbub {
     std::fill_n(disc, _numVertices, 0); // set to 0
     std::fill_n(low, _numVertices, 0); // set to 0
     std::fill_n(stacked, _numVertices, false); // set to 0
+    int64_t sccBytes = (2 * sizeof(int64_t) + sizeof(bool)) * _numVertices;
+    memoryChanged(MEM_PARTITION, sccBytes);
 
     // Set value of initial tick (clock), SCC Id 
     int64_t tick = 0;
@@ -147,6 +352,7 @@ namespace supbub {
     delete[] low;
     delete[] stacked;
     delete st;
+    memoryChanged(MEM_PARTITION, -sccBytes);
 
     return currentScc;
   }
@@ -162,6 +368,18 @@ namespace supbub {
     }
   }
   
+  //////////////////////// protected ////////////////////////
+
+  void
+  Graph::updateTrackedMemory(){
+    int64_t bytes = sizeof(int64_t) * (2 * _numVertices + _pendingTail.capacity() + _pendingHead.capacity());
+    if (_adjList.start != nullptr) {
+      bytes += sizeof(int64_t) * (2 * _numVertices + 2 + _adjList.start[_numVertices] + _parentList.start[_numVertices]);
+    }
+    memoryChanged(_memComponent, bytes - _trackedBytes);
+    _trackedBytes = bytes;
+  }
+
   //////////////////////// private ////////////////////////
 
 
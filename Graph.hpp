@@ -22,6 +22,7 @@
 
 #include "globalDefs.hpp"
 #include "helperDefs.hpp"
+#include "MemoryStats.hpp"
 
 namespace supbub{
 
@@ -29,6 +30,9 @@ namespace supbub{
    * A graph is represented as follows:
    *   - A vertex is represented by its vertex-id which is an int.
    *   - Edges between vertices are represented using ajacency list.
+   *     -- The lists of all vertices are stored contiguously (compressed sparse row form), one array for children and one for parents.
+   *     -- Edges are first collected by addEdge() and moved into these arrays by finalize(). The order in which edges of a vertex were added is kept.
+   *     -- The edges of an input are moved by finalizeUnique() instead, which sorts them and collapses duplicate edges.
    * A vertex and vertex-id are inter-changably used.
    * This class provides for the following:
    *  - Adding edges between vertices.
@@ -44,12 +48,29 @@ namespace supbub{
     typedef int64_t int64_t;
 
     
-    /** type for list of ids of vertices */
-    typedef std::list<int64_t> int64_t_LIST;
-
- 
     /** type for iterator of list of vertices */
-    typedef int64_t_LIST::iterator int64_t_LIST_ITERATOR;
+    typedef int64_t* int64_t_LIST_ITERATOR;
+
+    /** type for list of ids of vertices: a contiguous range of an adjacency array */
+    struct int64_t_LIST{
+      int64_t_LIST_ITERATOR first; // first id in the list
+      int64_t_LIST_ITERATOR last;  // one past the last id in the list
+
+      int64_t_LIST_ITERATOR begin() const { return first; }
+      int64_t_LIST_ITERATOR end() const { return last; }
+      bool empty() const { return first == last; }
+      int64_t size() const { return last - first; }
+    };
+
+    /** type for adjacency lists of all vertices in compressed sparse row form
+     * - list of vertex v is ids[start[v]] ... ids[start[v+1]-1]
+     */
+    struct ADJACENCY{
+      int64_t* start; // array of size (number of vertices + 1)
+      int64_t* ids;   // array of size (number of edges)
+
+      int64_t_LIST operator[](int64_t v) const { return int64_t_LIST{ids + start[v], ids + start[v+1]}; }
+    };
 
 
   class Graph{
@@ -61,37 +82,59 @@ namespace supbub{
      */
     Graph(int64_t n); 
 
-    /** Destructor */ 
-    ~Graph();
+    /** Constructor
+     * @param n total number of vertices
+     * @param component component to which the memory of the graph is accounted (see MemoryStats.hpp).
+     */
+    Graph(int64_t n, MemComponent component);
+
+    /** Destructor (virtual: the arrays of a SharedGraph are not its own) */ 
+    virtual ~Graph();
 
     /** Gives the number of vertices of graph. */
-    int64_t numVertices();
+    int64_t numVertices() { return _numVertices; }
 
     /** Gives the number of vertices of graph. */
-    int64_t numEdges();
+    int64_t numEdges() { return _numEdges; }
 
     /** Returns list of children of the vertex.
-     * Assumes v is valid.
+     * Assumes v is valid and the graph has been finalized.
      * @param v given vertex-id.
-     * @return reference to list of ids of child vertices.
+     * @return list of ids of child vertices.
      */
-    int64_t_LIST& getChildren(int64_t v);
+    int64_t_LIST getChildren(int64_t v) { return _adjList[v]; }
 
     /** Returns list of parents of the vertex.
-     * Assumes v is valid.
+     * Assumes v is valid and the graph has been finalized.
      * @param v given vertex-id.
-     * @return reference to list of ids of parent vertices
+     * @return list of ids of parent vertices
      *         
      */
-     int64_t_LIST& getParents(int64_t v);
+     int64_t_LIST getParents(int64_t v) { return _parentList[v]; }
 
-    /** Returns indegree of the vertex with given vertex-id (if v exists, -1 otherwise).
+    /** Returns indegree of the vertex with given vertex-id (if v exists, -1 otherwise in a checked build).
      */
-    int64_t getInDegree(int64_t v);
+    int64_t getInDegree(int64_t v) {
+#if SUPBUB_CHECKED
+      if (v >= _numVertices || v < 0) {
+	invalidId("Invalid v : ", v);
+	return -1;
+      }
+#endif
+      return _inDegree[v];
+    }
 
-    /** Returns outdegree of the vertex with given vertex-id (if v exists, -1 otherwise).
+    /** Returns outdegree of the vertex with given vertex-id (if v exists, -1 otherwise in a checked build).
      */
-    int64_t getOutDegree(int64_t v);
+    int64_t getOutDegree(int64_t v) {
+#if SUPBUB_CHECKED
+      if (v >= _numVertices || v < 0) {
+	invalidId("Invalid v : ", v);
+	return -1;
+      }
+#endif
+      return _outDegree[v];
+    }
 
 
 
@@ -101,6 +144,35 @@ namespace supbub{
      */
     void addEdge(int64_t u, int64_t v);
 
+    /** Reserves room for the given number of edges to be added (avoids the spare capacity of growing).
+     * @param m number of edges that will be added before the next finalize().
+     */
+    void reserveEdges(int64_t m);
+
+    /** Adds the given edges (tails[i] -> heads[i]), taking over the arrays instead of copying them when no edge is pending.
+     * Assumes all ids are valid (they are not checked, even in checked builds).
+     * @param tails reference to the ids of the source vertices of the edges (left empty).
+     * @param heads reference to the ids of the terminal vertices of the edges (left empty).
+     */
+    void addEdges(std::vector<int64_t>& tails, std::vector<int64_t>& heads);
+
+    /** Moves the edges added so far into the adjacency arrays.
+     * Must be called after the last addEdge() and before the children or parents of a vertex are queried.
+     * Edges may be added later again; finalize() has then to be called again.
+     * It does nothing if no edge has been added since the last call.
+     */
+    void finalize();
+
+    /** Moves the edges added so far into the adjacency arrays, each distinct edge once (for a graph whose edges have not been finalized before, e.g. the input).
+     * The edges are sorted on (tail, head) by a parallel radix sort, which makes duplicate edges adjacent; they are collapsed while both adjacency arrays are filled in one pass.
+     * Children and parents are then in increasing order of ids. The degrees and the number of edges are those of the edges kept.
+     * Besides the added edges, it takes as much memory again (the buffers of the sort, then the adjacency arrays).
+     * @param numThreads number of threads sorting the edges.
+     * @param dropSelfLoops if true, edges v-v are removed too.
+     * @return number of edges removed.
+     */
+    int64_t finalizeUnique(int numThreads, bool dropSelfLoops);
+
     /** Fills the given array with ids of the subgraphs(coresponding to 'scc') which corresponding vertex belongs to.
      * 
      * Each singleton vetex is added to the subgraph corresponding to id 0.
@@ -119,6 +191,13 @@ namespace supbub{
 
     //////////////////////// protected ////////////////////////
   protected:
+    /** Constructor
+     * @param n total number of vertices
+     * @param component component to which the memory of the graph is accounted (see MemoryStats.hpp).
+     * @param adjacency if false, the adjacency arrays are not allocated (only the degrees): edges are then neither added nor queried through this class (see DAG).
+     */
+    Graph(int64_t n, MemComponent component, bool adjacency);
+
     /** total number of vertices in the graph */
     int64_t _numVertices;
 
@@ -126,14 +205,18 @@ namespace supbub{
     int64_t _numEdges;
 
     /** adjacency list
-     *  it is the pointer to an array where an element at index say 'u' is a pointer to a list of ids 'v' of all vertices such that there is an edge from the vertex with id u to the vertex with id v.
+     *  _adjList[u] is the list of ids 'v' of all vertices such that there is an edge from the vertex with id u to the vertex with id v.
      */
-    int64_t_LIST* _adjList;
+    ADJACENCY _adjList;
 
     /** parent list
-     *  it is the pointer to an array where an element at index say 'u' is a pointer to a list of ids 'v' of all vertices such that there is an edge from the vertex with id v to the vertex with id u.
+     *  _parentList[u] is the list of ids 'v' of all vertices such that there is an edge from the vertex with id v to the vertex with id u.
      */
-    int64_t_LIST* _parentList;
+    ADJACENCY _parentList;
+
+    /** edges added since the last finalize(): edge i is _pendingTail[i] -> _pendingHead[i] */
+    std::vector<int64_t> _pendingTail;
+    std::vector<int64_t> _pendingHead;
 
     /** array of indegree of each vertex
      *  it is the pointer to an array where an element at index say 'u' containes n where n is indegree of the vertexwith id  u.
@@ -144,6 +227,15 @@ namespace supbub{
      *  it is the pointer to an array where an element at index say 'u' containes n where n is outdegree of the vertex with id u.
      */
     int64_t* _outDegree;
+
+    /** component to which the memory of the graph is accounted */
+    MemComponent _memComponent;
+
+    /** number of bytes of the graph accounted so far */
+    int64_t _trackedBytes;
+
+    /** Accounts the current size of the adjacency arrays, degrees and pending edges (the difference with the last call). */
+    void updateTrackedMemory();
  
     //////////////////////// private ////////////////////////
   private:
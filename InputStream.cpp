@@ -0,0 +1,347 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class InputStream
+ */
+#include "InputStream.hpp"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <zlib.h>
+#if SUPBUB_ZSTD
+#include <zstd.h>
+#endif
+
+namespace supbub{
+
+  /* number of buffers of the ring, and size of each */
+  static const int RING_BUFFERS = 4;
+  static const size_t RING_BUFFER_SIZE = 1 << 20;
+
+  /* size of the buffer of the input as read */
+  static const size_t RAW_BUFFER_SIZE = 1 << 20;
+
+  InputStream::InputStream() {
+    _format = FORMAT_PLAIN;
+    _fd = -1;
+    _raw = nullptr;
+    _rawBegin = 0;
+    _rawEnd = 0;
+    _ring = nullptr;
+    _sizes = nullptr;
+    _filled = 0;
+    _produced = 0;
+    _next = 0;
+    _holding = false;
+    _done = false;
+    _stop = false;
+    _error = nullptr;
+    setg(nullptr, nullptr, nullptr);
+  }
+
+  InputStream::~InputStream() {
+    if (_thread.joinable()) {
+      {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_stop = true;
+      }
+      _changed.notify_all();
+      _thread.join();
+    }
+    if (_fd > STDIN_FILENO) {
+      close(_fd);
+    }
+    delete[] _raw;
+    delete[] _ring;
+    delete[] _sizes;
+  }
+
+  bool
+  InputStream::open(const std::string& filename){
+    _fd = (filename == "-") ? STDIN_FILENO : ::open(filename.c_str(), O_RDONLY);
+    if (_fd == -1) {
+      _error = strerror(errno);
+      return false;
+    }
+    _raw = new char[RAW_BUFFER_SIZE];
+    // the first bytes give the format (a pipe may give them in several reads)
+    while (_rawEnd < 4) {
+      int64_t r = readRaw();
+      if (r < 0) {
+	_error = "read error";
+	return false;
+      }
+      if (r == 0) {
+	break;
+      }
+    }
+    const unsigned char* magic = reinterpret_cast<const unsigned char*>(_raw);
+    if (_rawEnd >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+      _format = FORMAT_GZIP;
+    }
+    else if (_rawEnd >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+#if SUPBUB_ZSTD
+      _format = FORMAT_ZSTD;
+#else
+      _error = "zstd input is not supported by this build (make ZSTD=1)";
+      return false;
+#endif
+    }
+    _ring = new char[RING_BUFFERS * RING_BUFFER_SIZE];
+    _sizes = new size_t[RING_BUFFERS];
+    _thread = std::thread(&InputStream::produce, this);
+    return true;
+  }
+
+  const char*
+  InputStream::error(){
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _error;
+  }
+
+  //////////////////////// protected ////////////////////////
+
+  InputStream::int_type
+  InputStream::underflow(){
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_holding) { // give the buffer parsed back to the thread
+      _holding = false;
+      _filled--;
+      _next++;
+      _changed.notify_all();
+    }
+    _changed.wait(lock, [this] { return _filled > 0 || _done; });
+    if (_filled == 0) {
+      return traits_type::eof();
+    }
+    _holding = true;
+    char* buffer = _ring + (_next % RING_BUFFERS) * RING_BUFFER_SIZE;
+    setg(buffer, buffer, buffer + _sizes[_next % RING_BUFFERS]);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  //////////////////////// private ////////////////////////
+
+  void
+  InputStream::produce(){
+    const char* error = nullptr;
+    switch (_format) {
+    case FORMAT_PLAIN:
+      error = copyPlain();
+      break;
+    case FORMAT_GZIP:
+      error = inflateGzip();
+      break;
+    case FORMAT_ZSTD:
+      error = decompressZstd();
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _error = error;
+      _done = true;
+    }
+    _changed.notify_all();
+  }
+
+  char*
+  InputStream::acquireBuffer(){
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait(lock, [this] { return _filled < RING_BUFFERS || _stop; });
+    return _stop ? nullptr : _ring + (_produced % RING_BUFFERS) * RING_BUFFER_SIZE;
+  }
+
+  void
+  InputStream::releaseBuffer(size_t size){
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _sizes[_produced % RING_BUFFERS] = size;
+      _produced++;
+      _filled++;
+    }
+    _changed.notify_all();
+  }
+
+  int64_t
+  InputStream::readRaw(){
+    if (_rawBegin > 0) {
+      memmove(_raw, _raw + _rawBegin, _rawEnd - _rawBegin);
+      _rawEnd -= _rawBegin;
+      _rawBegin = 0;
+    }
+    ssize_t r;
+    do {
+      r = read(_fd, _raw + _rawEnd, RAW_BUFFER_SIZE - _rawEnd);
+    } while (r == -1 && errno == EINTR);
+    if (r > 0) {
+      _rawEnd += r;
+    }
+    return r;
+  }
+
+  const char*
+  InputStream::copyPlain(){
+    while (true) {
+      char* out = acquireBuffer();
+      if (out == nullptr) {
+	return nullptr;
+      }
+      // the bytes read to find the format come first
+      size_t size = std::min(_rawEnd - _rawBegin, RING_BUFFER_SIZE);
+      memcpy(out, _raw + _rawBegin, size);
+      _rawBegin += size;
+      while (size < RING_BUFFER_SIZE) {
+	ssize_t r;
+	do {
+	  r = read(_fd, out + size, RING_BUFFER_SIZE - size);
+	} while (r == -1 && errno == EINTR);
+	if (r <= 0) {
+	  if (size > 0) {
+	    releaseBuffer(size);
+	  }
+	  return (r == 0) ? nullptr : "read error";
+	}
+	size += r;
+      }
+      releaseBuffer(size);
+    }
+  }
+
+  const char*
+  InputStream::inflateGzip(){
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) { // (gzip header)
+      return "cannot initialize zlib";
+    }
+    const char* error = nullptr;
+    bool end = false; // all the input has been read
+    char* out = acquireBuffer();
+    size_t size = 0;
+    while (out != nullptr) {
+      if (_rawBegin == _rawEnd && !end) {
+	int64_t r = readRaw();
+	if (r < 0) {
+	  error = "read error";
+	  break;
+	}
+	end = (r == 0);
+      }
+      zs.next_in = reinterpret_cast<Bytef*>(_raw + _rawBegin);
+      zs.avail_in = _rawEnd - _rawBegin;
+      zs.next_out = reinterpret_cast<Bytef*>(out + size);
+      zs.avail_out = RING_BUFFER_SIZE - size;
+      int status = inflate(&zs, Z_NO_FLUSH);
+      _rawBegin = _rawEnd - zs.avail_in;
+      size = RING_BUFFER_SIZE - zs.avail_out;
+      if (status == Z_STREAM_END) {
+	// another member may follow
+	if (_rawBegin == _rawEnd && !end) {
+	  int64_t r = readRaw();
+	  if (r < 0) {
+	    error = "read error";
+	    break;
+	  }
+	  end = (r == 0);
+	}
+	if (_rawBegin == _rawEnd) {
+	  break;
+	}
+	inflateReset(&zs);
+      }
+      else if (status == Z_BUF_ERROR && end) { // no progress, and no more input
+	error = "truncated gzip input";
+	break;
+      }
+      else if (status != Z_OK && status != Z_BUF_ERROR) {
+	error = (zs.msg != nullptr) ? zs.msg : "corrupt gzip input";
+	break;
+      }
+      if (size == RING_BUFFER_SIZE) {
+	releaseBuffer(size);
+	size = 0;
+	out = acquireBuffer();
+      }
+    }
+    if (out != nullptr && size > 0) {
+      releaseBuffer(size);
+    }
+    inflateEnd(&zs);
+    return error;
+  }
+
+  const char*
+  InputStream::decompressZstd(){
+#if SUPBUB_ZSTD
+    ZSTD_DStream* zs = ZSTD_createDStream();
+    if (zs == nullptr || ZSTD_isError(ZSTD_initDStream(zs))) {
+      ZSTD_freeDStream(zs);
+      return "cannot initialize zstd";
+    }
+    const char* error = nullptr;
+    bool end = false; // all the input has been read
+    bool complete = false; // the last frame has been decompressed completely
+    char* out = acquireBuffer();
+    size_t size = 0;
+    while (out != nullptr) {
+      if (_rawBegin == _rawEnd && !end) {
+	int64_t r = readRaw();
+	if (r < 0) {
+	  error = "read error";
+	  break;
+	}
+	end = (r == 0);
+      }
+      ZSTD_inBuffer in = {_raw + _rawBegin, _rawEnd - _rawBegin, 0};
+      ZSTD_outBuffer output = {out, RING_BUFFER_SIZE, size};
+      size_t status = ZSTD_decompressStream(zs, &output, &in);
+      if (ZSTD_isError(status)) {
+	error = ZSTD_getErrorName(status);
+	break;
+      }
+      bool progress = (in.pos > 0 || output.pos > size);
+      _rawBegin += in.pos;
+      size = output.pos;
+      if (progress) {
+	complete = (status == 0);
+      }
+      else if (end && _rawBegin == _rawEnd) { // no more input
+	if (!complete) {
+	  error = "truncated zstd input";
+	}
+	break;
+      }
+      if (size == RING_BUFFER_SIZE) {
+	releaseBuffer(size);
+	size = 0;
+	out = acquireBuffer();
+      }
+    }
+    if (out != nullptr && size > 0) {
+      releaseBuffer(size);
+    }
+    ZSTD_freeDStream(zs);
+    return error;
+#else
+    return "zstd input is not supported by this build";
+#endif
+  }
+
+} // end namespace
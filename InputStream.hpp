@@ -0,0 +1,146 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class InputStream.
+ * It is the stream buffer from which the input graph is parsed: a plain, gzip or zstd file (detected by its first bytes), or the standard input.
+ */
+
+#ifndef INPUT_STREAM_HPP
+#define INPUT_STREAM_HPP
+
+#include "globalDefs.hpp"
+
+#include <streambuf>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace supbub{
+
+  /** Class InputStream
+   * A background thread reads the input and, if it is compressed, decompresses it into a ring of buffers; the parser reads the buffers in turn (through a std::istream),
+   * so decompression and parsing overlap, and no decompressed copy is written to disk. The input is read sequentially: pipes and the standard input work as well as files.
+   * The format is given by the first bytes: gzip (1f 8b, concatenated members are read one after the other), zstd (28 b5 2f fd, only if built with SUPBUB_ZSTD, i.e. make ZSTD=1), plain text otherwise.
+   *
+   * This class provides for the following:
+   *  - Opening a file (or the standard input) and starting the thread.
+   *  - Giving the characters of the (decompressed) input to a std::istream.
+   *  - Reporting a read or decompression error once the end of the input is reached.
+   */
+
+  class InputStream : public std::streambuf{
+
+  public:
+
+    /** Constructor (nothing opened) */
+    InputStream();
+
+    /** Destructor: stops the thread (if the input has not been read to the end) and closes the file. */
+    ~InputStream();
+
+    /** Opens the given file (the standard input if it is "-"), finds its format and starts the thread.
+     * @param filename name of the file.
+     * @return false if the file cannot be opened or its format is not supported (see error()).
+     */
+    bool open(const std::string& filename);
+
+    /** Returns the description of the error which ended the input early (the input then seems to end there), or nullptr if none. */
+    const char* error();
+
+    //////////////////////// protected ////////////////////////
+  protected:
+
+    /** Gives the next buffer to the parser, waiting for the thread if it is not filled yet. */
+    int_type underflow();
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** formats of the input */
+    enum Format { FORMAT_PLAIN, FORMAT_GZIP, FORMAT_ZSTD };
+
+    /** format of the input */
+    Format _format;
+
+    /** file descriptor of the input (-1 if not opened) */
+    int _fd;
+
+    /** input as read (compressed): _raw[_rawBegin.._rawEnd) is not consumed yet */
+    char* _raw;
+    size_t _rawBegin;
+    size_t _rawEnd;
+
+    /** ring of buffers: buffer k is _ring + k * RING_BUFFER_SIZE and holds _sizes[k] characters */
+    char* _ring;
+    size_t* _sizes;
+
+    /** number of buffers filled and not yet given back by the parser (including the one it holds) */
+    int _filled;
+
+    /** number of buffers filled by the thread so far (the next one is _produced % RING_BUFFERS) */
+    int64_t _produced;
+
+    /** number of buffers given back by the parser (the one it holds, or reads next, is _next % RING_BUFFERS) */
+    int64_t _next;
+
+    /** true if the parser holds a buffer */
+    bool _holding;
+
+    /** true once the thread has filled its last buffer */
+    bool _done;
+
+    /** true to make the thread stop early */
+    bool _stop;
+
+    /** error met by the thread (nullptr if none) */
+    const char* _error;
+
+    /** protects _filled, _done, _stop and _error */
+    std::mutex _mutex;
+
+    /** notified when a buffer is filled or given back, and when the thread ends or has to stop */
+    std::condition_variable _changed;
+
+    /** thread reading (and decompressing) the input */
+    std::thread _thread;
+
+    /** Body of the thread: fills the buffers in turn until the end of the input (or an error, or stop). */
+    void produce();
+
+    /** Waits for the next buffer of the ring to be free (for the thread).
+     * @return pointer to the buffer, or nullptr if the thread has to stop.
+     */
+    char* acquireBuffer();
+
+    /** Hands the buffer acquired last over to the parser.
+     * @param size number of characters written in it (not 0).
+     */
+    void releaseBuffer(size_t size);
+
+    /** Reads more of the input into _raw (after moving the part not consumed to its beginning).
+     * @return the number of bytes read, 0 at the end of the input, -1 on an error.
+     */
+    int64_t readRaw();
+
+    /** Copies, inflates or decompresses the input into the buffers.
+     * @return nullptr at the end of the input, the description of the error otherwise.
+     */
+    const char* copyPlain();
+    const char* inflateGzip();
+    const char* decompressZstd();
+  };
+
+} // end namespace
+#endif
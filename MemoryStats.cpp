@@ -0,0 +1,294 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements the memory accounting, the recording of stages and the estimation of memory needs.
+ */
+#include "MemoryStats.hpp"
+#include "CandidateList.hpp"
+#include "DetectSuperBubble.hpp"
+#include "helperDefs.hpp"
+
+#include <atomic>
+#include <sys/resource.h>
+
+namespace supbub{
+
+  //////////////////////// accounting ////////////////////////
+
+  /* bytes currently held, and peak, by each component and by all of them together */
+  static std::atomic<int64_t> currentBytes[MEM_NUM_COMPONENTS];
+  static std::atomic<int64_t> peakBytes[MEM_NUM_COMPONENTS];
+  static std::atomic<int64_t> currentTotalBytes(0);
+  static std::atomic<int64_t> peakTotalBytes(0);
+
+  /* peaks since the end of the last stage */
+  static std::atomic<int64_t> stagePeakBytes[MEM_NUM_COMPONENTS];
+  static std::atomic<int64_t> stagePeakTotalBytes(0);
+
+  static inline void
+  updateMax(std::atomic<int64_t>& max, int64_t value){
+    int64_t old = max.load(std::memory_order_relaxed);
+    while (value > old && !max.compare_exchange_weak(old, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  const char*
+  memComponentName(MemComponent component){
+    switch (component) {
+    case MEM_GRAPH:
+      return "graph";
+    case MEM_PARTITION:
+      return "partition";
+    case MEM_SUBGRAPH:
+      return "subgraph";
+    case MEM_DAG:
+      return "dag";
+    case MEM_CANDIDATES:
+      return "candidates";
+    case MEM_RMQ:
+      return "rmq";
+    case MEM_RESULTS:
+      return "results";
+    default:
+      return "unknown";
+    }
+  }
+
+  void
+  memoryChanged(MemComponent component, int64_t bytes){
+    int64_t value = currentBytes[component].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    int64_t total = currentTotalBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (bytes > 0) {
+      updateMax(peakBytes[component], value);
+      updateMax(stagePeakBytes[component], value);
+      updateMax(peakTotalBytes, total);
+      updateMax(stagePeakTotalBytes, total);
+    }
+  }
+
+  int64_t
+  currentMemory(MemComponent component){
+    return currentBytes[component].load(std::memory_order_relaxed);
+  }
+
+  int64_t
+  peakMemory(MemComponent component){
+    return peakBytes[component].load(std::memory_order_relaxed);
+  }
+
+  int64_t
+  peakTrackedMemory(){
+    return peakTotalBytes.load(std::memory_order_relaxed);
+  }
+
+  int64_t
+  peakRSS(){
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+      return -1;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss; // in bytes
+#else
+    return int64_t(usage.ru_maxrss) * 1024; // in kilobytes
+#endif
+  }
+
+  //////////////////////// stages ////////////////////////
+
+  /** type for a recorded stage */
+  struct Stage{
+    std::string name;
+    double seconds;                          // duration of the stage
+    int64_t peak[MEM_NUM_COMPONENTS];        // peak of each component during the stage
+    int64_t peakTotal;                       // peak of all components together during the stage
+    int64_t peakRSS;                         // peak RSS of the process at the end of the stage
+  };
+
+  static std::vector<Stage> stages;
+  static double lastMark = gettime();
+
+  void
+  markStage(const char* name){
+    double now = gettime();
+    Stage stage;
+    stage.name = name;
+    stage.seconds = now - lastMark;
+    for (int c = 0; c < MEM_NUM_COMPONENTS; ++c) {
+      stage.peak[c] = stagePeakBytes[c].exchange(currentBytes[c].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    stage.peakTotal = stagePeakTotalBytes.exchange(currentTotalBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    stage.peakRSS = peakRSS();
+    stages.push_back(stage);
+    lastMark = now;
+  }
+
+  static double
+  toMB(int64_t bytes){
+    return bytes / (1024.0 * 1024.0);
+  }
+
+  void
+  printMemoryReport(FILE* out){
+    fprintf(out, "%-20s %9s", "Stage", "Time(s)");
+    for (int c = 0; c < MEM_NUM_COMPONENTS; ++c) {
+      fprintf(out, " %10s", memComponentName(MemComponent(c)));
+    }
+    fprintf(out, " %10s %10s   (peaks in MB)\n", "tracked", "RSS");
+    for (size_t s = 0; s < stages.size(); ++s) {
+      const Stage& stage = stages[s];
+      fprintf(out, "%-20s %9.3f", stage.name.c_str(), stage.seconds);
+      for (int c = 0; c < MEM_NUM_COMPONENTS; ++c) {
+	fprintf(out, " %10.1f", toMB(stage.peak[c]));
+      }
+      fprintf(out, " %10.1f %10.1f\n", toMB(stage.peakTotal), toMB(stage.peakRSS));
+    }
+    fprintf(out, "%-20s %9s", "Overall", "");
+    for (int c = 0; c < MEM_NUM_COMPONENTS; ++c) {
+      fprintf(out, " %10.1f", toMB(peakMemory(MemComponent(c))));
+    }
+    fprintf(out, " %10.1f %10.1f\n", toMB(peakTrackedMemory()), toMB(peakRSS()));
+  }
+
+  //////////////////////// estimation ////////////////////////
+  // The formulas follow the allocations of Graph, Subgraph, DAG, CandidateList, the rmq structures and DetectSuperBubble.
+
+  static const int64_t W = sizeof(int64_t);
+
+  /* buffer of the temporary file of PartitionSpill */
+  static const int64_t SPILL_BUFFER_BYTES = 1 << 22;
+
+  /* capacity reached by a vector after n push_back (grown by doubling) */
+  static int64_t
+  vectorCapacity(int64_t n){
+    int64_t capacity = (n > 0) ? 1 : 0;
+    while (capacity < n) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  /* finalized graph: adjacency and parent arrays, degrees */
+  static int64_t
+  graphBytes(int64_t n, int64_t m){
+    return W * (4 * n + 2 + 2 * m);
+  }
+
+  /* graph while finalize() moves the added edges (stored with the given capacity) into the adjacency arrays (along with the old start arrays and the fill positions) */
+  static int64_t
+  graphBuildBytes(int64_t n, int64_t m, int64_t capacity){
+    return graphBytes(n, m) + 2 * W * capacity + 4 * W * n;
+  }
+
+  /* input graph while finalizeUnique() sorts the added edges (stored with the given capacity, and as many in the buffers of the sort), then fills the adjacency arrays while the sorted edges are kept (in either) */
+  static int64_t
+  inputGraphBuildBytes(int64_t n, int64_t m, int64_t capacity){
+    return 2 * W * n + 2 * W * capacity + std::max(2 * W * m, W * (2 * n + 2 + 2 * m));
+  }
+
+  /* Fills peak[] with the needs of processing one subgraph of n vertices (except r and r') and m edges. Returns their sum. */
+  static int64_t
+  estimateDetection(int64_t n, int64_t m, bool cyclic, bool blockRmq, bool relabel, int64_t* peak){
+    int64_t sn = n + 2;
+    int64_t dn = cyclic ? 2 * n + 2 : sn; // vertices of the DAG
+    int64_t dm = cyclic ? 2 * m + 2 * n : m; // edges of the DAG (at most)
+    std::fill_n(peak, MEM_NUM_COMPONENTS, 0);
+    // subgraph with its reverse id map (and the 32 bits ancestor index and the stack of the DFS while building the DAG)
+    peak[MEM_SUBGRAPH] = graphBytes(sn, m) + W * sn + (cyclic ? (2 * 4 + 2 * W) * sn : 0);
+    // DAG (degrees and flags of the edges from r and to r' of a doubled DAG, whose edges are stored only when relabelled),
+    // along with invOrd, ordD, pvsEntrance, outParent, outChild, visited and the result arrays (with their 32 bits stamps, kept for the next DAGs)
+    int64_t dag;
+    if (cyclic) {
+      dag = 2 * W * dn + dn + (relabel ? graphBytes(dn, dm) : 0);
+    } else {
+      dag = (relabel ? 2 : 1) * graphBytes(dn, dm);
+    }
+    peak[MEM_DAG] = dag + (7 * W + 2 * 4) * dn + dn;
+    if (!cyclic) { // while built
+      peak[MEM_DAG] = std::max(peak[MEM_DAG], graphBuildBytes(dn, dm, vectorCapacity(dm)));
+    }
+    // at most an entrance and an exit candidate per vertex
+    peak[MEM_CANDIDATES] = 2 * dn * int64_t(sizeof(Candidate));
+    if (blockRmq) { // two sparse tables over blocks of 64
+      int64_t blocks = dn / 64 + 1;
+      int64_t levels = 1;
+      while ((int64_t(1) << levels) <= blocks) {
+	++levels;
+      }
+      peak[MEM_RMQ] = 2 * W * blocks * levels;
+    } else { // copy in an int_vector while building, about 4 bits per element for each succinct rmq
+      peak[MEM_RMQ] = W * dn + dn;
+    }
+    return peak[MEM_SUBGRAPH] + peak[MEM_DAG] + peak[MEM_CANDIDATES] + peak[MEM_RMQ];
+  }
+
+  void
+  estimateMemory(int64_t numVertices, int64_t numEdges, int64_t sccVertices, int64_t sccEdges, bool blockRmq, bool relabel, MemoryEstimate& estimate){
+    // the singletons (in one weakly connected component) and all non-singleton sccs, both with their edges from r and to r'
+    int64_t n[2] = {numVertices - sccVertices, sccVertices};
+    int64_t m[2] = {numEdges - sccEdges + 2 * n[0], sccEdges + 2 * n[1]};
+    int numSubgraphs = (sccVertices > 0) ? 2 : 1;
+
+    std::fill_n(estimate.peak, MEM_NUM_COMPONENTS, 0);
+    estimate.peak[MEM_GRAPH] = inputGraphBuildBytes(numVertices, numEdges, vectorCapacity(numEdges));
+    // scc ids, id maps and vertices grouped by subgraph, or the arrays of Tarjan's algorithm
+    estimate.peak[MEM_PARTITION] = 4 * W * numVertices + numVertices;
+    // at most one superbubble per vertex (with the links of the list)
+    estimate.peak[MEM_RESULTS] = (sizeof(DetectSuperBubble::SuperBubble) + 2 * sizeof(void*)) * numVertices;
+
+    // subgraphs are built (with their exact number of edges) and processed one at a time
+    int64_t largest = 0;
+    for (int sg = 0; sg < numSubgraphs; ++sg) {
+      int64_t sn = n[sg] + 2;
+      int64_t peak[MEM_NUM_COMPONENTS];
+      int64_t build = graphBuildBytes(sn, m[sg], m[sg]) + W * sn;
+      int64_t detection = estimateDetection(n[sg], m[sg], sg == 1, blockRmq, relabel, peak);
+      peak[MEM_SUBGRAPH] = std::max(peak[MEM_SUBGRAPH], build);
+      for (int c = 0; c < MEM_NUM_COMPONENTS; ++c) {
+	estimate.peak[c] = std::max(estimate.peak[c], peak[c]);
+      }
+      largest = std::max(largest, std::max(build, detection));
+    }
+
+    int64_t graph = graphBytes(numVertices, numEdges);
+    // find(): the graph is kept until the end
+    estimate.total = std::max(estimate.peak[MEM_GRAPH],
+			      graph + estimate.peak[MEM_PARTITION] + largest + estimate.peak[MEM_RESULTS]);
+    // partitionToDisk() then findFromDisk(): the graph is released before detection
+    estimate.totalSpill = std::max(estimate.peak[MEM_GRAPH],
+				   std::max(graph + estimate.peak[MEM_PARTITION] + SPILL_BUFFER_BYTES,
+					    largest + estimate.peak[MEM_RESULTS]));
+  }
+
+  int64_t
+  estimateSubgraphBytes(int64_t numVertices, int64_t numEdges, bool blockRmq, bool relabel){
+    int64_t peak[MEM_NUM_COMPONENTS];
+    return estimateDetection(numVertices, numEdges, true, blockRmq, relabel, peak);
+  }
+
+  void
+  printMemoryEstimate(FILE* out, int64_t numVertices, int64_t numEdges, bool blockRmq, bool relabel){
+    MemoryEstimate acyclic, cyclic;
+    estimateMemory(numVertices, numEdges, 0, 0, blockRmq, relabel, acyclic);
+    estimateMemory(numVertices, numEdges, numVertices, numEdges, blockRmq, relabel, cyclic);
+    fprintf(out, "%-24s %12s %12s   (peaks in MB)\n", "Component", "acyclic", "one scc");
+    for (int c = 0; c < MEM_NUM_COMPONENTS; ++c) {
+      fprintf(out, "%-24s %12.1f %12.1f\n", memComponentName(MemComponent(c)), toMB(acyclic.peak[c]), toMB(cyclic.peak[c]));
+    }
+    fprintf(out, "%-24s %12.1f %12.1f\n", "total (in memory)", toMB(acyclic.total), toMB(cyclic.total));
+    fprintf(out, "%-24s %12.1f %12.1f\n", "total (spilled to disk)", toMB(acyclic.totalSpill), toMB(cyclic.totalSpill));
+  }
+
+} // end namespace
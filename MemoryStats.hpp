@@ -0,0 +1,103 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Declares the accounting of the memory used by each component, the recording of stages and the estimation of memory needs.
+ * Components report the bytes they allocate and release; the current and peak bytes of each component are kept (globally, safe to update from several threads).
+ * A stage is marked when it ends: its time, the peak of each component during the stage and the peak RSS of the process so far are recorded.
+ */
+
+#ifndef MEMORY_STATS_HPP
+#define MEMORY_STATS_HPP
+
+#include "globalDefs.hpp"
+
+namespace supbub{
+
+  /** components whose memory is accounted */
+  enum MemComponent {
+    MEM_GRAPH,       // input graph (adjacency arrays, degrees, edges not yet finalized)
+    MEM_PARTITION,   // scc ids and id maps used while partitioning
+    MEM_SUBGRAPH,    // subgraphs (adjacency arrays, id maps, dfs times)
+    MEM_DAG,         // DAGs (adjacency arrays, orders, outParent/outChild, result arrays)
+    MEM_CANDIDATES,  // candidate lists
+    MEM_RMQ,         // range query structures
+    MEM_RESULTS,     // list of superbubbles found
+    MEM_NUM_COMPONENTS
+  };
+
+  /** Returns the name of the given component. */
+  const char* memComponentName(MemComponent component);
+
+  /** Records that bytes have been allocated (bytes > 0) or released (bytes < 0) by the given component. */
+  void memoryChanged(MemComponent component, int64_t bytes);
+
+  /** Gives the number of bytes currently held by the given component. */
+  int64_t currentMemory(MemComponent component);
+
+  /** Gives the largest number of bytes held by the given component so far. */
+  int64_t peakMemory(MemComponent component);
+
+  /** Gives the largest number of bytes held by all components together so far. */
+  int64_t peakTrackedMemory();
+
+  /** Gives the peak resident set size of the process so far (in bytes), or -1 if unknown. */
+  int64_t peakRSS();
+
+  /** Records the end of a stage (which began at the end of the previous one, or at the start of the program).
+   * Must be called from one thread only.
+   * @param name name of the stage.
+   */
+  void markStage(const char* name);
+
+  /** Prints a table of the recorded stages (time, peak of each component and peak RSS) followed by the peaks of the components. */
+  void printMemoryReport(FILE* out);
+
+  /** struct for estimated memory needs (in bytes) */
+  struct MemoryEstimate{
+    int64_t peak[MEM_NUM_COMPONENTS]; // peak of each component
+    int64_t total;       // peak of all components together when all subgraphs are kept in memory (find)
+    int64_t totalSpill;  // peak of all components together when subgraphs are spilled to disk (partitionToDisk, findFromDisk)
+  };
+
+  /** Estimates the memory needed to find superbubbles in a graph, without building it.
+   * The vertices of non-singleton sccs are assumed to form a single scc (which is the worst case for the largest DAG).
+   * @param numVertices number of vertices of the graph.
+   * @param numEdges number of edges of the graph.
+   * @param sccVertices number of vertices belonging to non-singleton sccs.
+   * @param sccEdges number of edges between vertices of the same non-singleton scc.
+   * @param blockRmq true if BlockRMQ is used instead of the succinct rmq.
+   * @param relabel true if the vertices of the DAGs are relabelled in topological order (the edges of a doubled DAG are then stored).
+   * @param estimate reference to the estimate to be filled in.
+   */
+  void estimateMemory(int64_t numVertices, int64_t numEdges, int64_t sccVertices, int64_t sccEdges, bool blockRmq, bool relabel, MemoryEstimate& estimate);
+
+  /** Estimates the number of bytes needed to process a (cyclic) subgraph: the subgraph, its DAG and the structures used for detection.
+   * @param numVertices number of vertices of the subgraph (except r and r').
+   * @param numEdges number of edges of the subgraph.
+   * @param blockRmq true if BlockRMQ is used instead of the succinct rmq.
+   * @param relabel true if the vertices of the DAG are relabelled in topological order.
+   */
+  int64_t estimateSubgraphBytes(int64_t numVertices, int64_t numEdges, bool blockRmq, bool relabel);
+
+  /** Prints the estimates for a graph in the two extreme cases: no cycle at all, and all vertices in one scc.
+   * @param numVertices number of vertices of the graph.
+   * @param numEdges number of edges of the graph.
+   * @param blockRmq true if BlockRMQ is used instead of the succinct rmq.
+   * @param relabel true if the vertices of the DAGs are relabelled in topological order.
+   */
+  void printMemoryEstimate(FILE* out, int64_t numVertices, int64_t numEdges, bool blockRmq, bool relabel);
+
+} // end namespace
+#endif
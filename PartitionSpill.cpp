@@ -0,0 +1,131 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class PartitionSpill
+ */
+#include "PartitionSpill.hpp"
+
+#include <unistd.h>
+#include <cstdlib>
+
+namespace supbub{
+
+  /* size of the buffer of the temporary file */
+  static const size_t SPILL_BUFFER_SIZE = 1 << 22;
+
+  PartitionSpill::PartitionSpill() {
+    _file = nullptr;
+    _numAcyclic = 0;
+    _written = 0;
+    _buffer = nullptr;
+  }
+
+  PartitionSpill::~PartitionSpill() {
+    if (_file != nullptr) {
+      fclose(_file);
+    }
+    delete[] _buffer;
+  }
+
+  bool
+  PartitionSpill::open(const std::string& dir){
+    std::string path = dir + "/supbub-spill-XXXXXX";
+    char* name = new char[path.size() + 1];
+    path.copy(name, path.size());
+    name[path.size()] = '\0';
+    int fd = mkstemp(name);
+    if (fd != -1) {
+      unlink(name); // removed when closed
+      _file = fdopen(fd, "w+b");
+    }
+    delete[] name;
+    if (_file == nullptr) {
+      return false;
+    }
+    _buffer = new char[SPILL_BUFFER_SIZE];
+    setvbuf(_file, _buffer, _IOFBF, SPILL_BUFFER_SIZE);
+    return true;
+  }
+
+  void
+  PartitionSpill::beginSubgraph(const int64_t* globalIds, int64_t numVertices, bool acyclic){
+    _index.push_back(Entry{_written, numVertices, 0});
+    _numAcyclic += acyclic ? 1 : 0;
+    fwrite(globalIds, sizeof(int64_t), numVertices, _file);
+    _written += numVertices * sizeof(int64_t);
+  }
+
+  void
+  PartitionSpill::addEdge(int64_t u, int64_t v){
+    int64_t edge[2] = {u, v};
+    fwrite(edge, sizeof(int64_t), 2, _file);
+    _written += 2 * sizeof(int64_t);
+    _index.back().numEdges++;
+  }
+
+  bool
+  PartitionSpill::flush(){
+    return (fflush(_file) == 0 && !ferror(_file));
+  }
+
+  int64_t
+  PartitionSpill::numSubgraphs(){
+    return _index.size();
+  }
+
+  int64_t
+  PartitionSpill::numAcyclic(){
+    return _numAcyclic;
+  }
+
+  int64_t
+  PartitionSpill::numVertices(int64_t sg){
+    return _index[sg].numVertices;
+  }
+
+  int64_t
+  PartitionSpill::numEdges(int64_t sg){
+    return _index[sg].numEdges;
+  }
+
+  Subgraph*
+  PartitionSpill::readSubgraph(int64_t sg){
+    const Entry& entry = _index[sg];
+    if (fseeko(_file, entry.offset, SEEK_SET) != 0) {
+      return nullptr;
+    }
+    Subgraph* subgraph = new Subgraph(entry.numVertices + 2); // two additional vetices for r(source) and r'(terminal/sink) resp.
+    int64_t globalId;
+    for (int64_t v = 0; v < entry.numVertices; ++v) {
+      if (fread(&globalId, sizeof(int64_t), 1, _file) != 1) {
+	delete subgraph;
+	return nullptr;
+      }
+      subgraph->setGlobalId(v, globalId);
+    }
+    subgraph->reserveEdges(entry.numEdges);
+    int64_t edge[2];
+    for (int64_t e = 0; e < entry.numEdges; ++e) {
+      if (fread(edge, sizeof(int64_t), 2, _file) != 2) {
+	delete subgraph;
+	return nullptr;
+      }
+      subgraph->addEdge(edge[0], edge[1]);
+    }
+    subgraph->finalize();
+    return subgraph;
+  }
+
+} // end namespace
@@ -0,0 +1,118 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class PartitionSpill.
+ * It keeps the subgraphs obtained by partitioning a graph in a temporary file, so that they can be processed one at a time.
+ */
+
+#ifndef PARTITION_SPILL_HPP
+#define PARTITION_SPILL_HPP
+
+#include "Subgraph.hpp"
+
+namespace supbub{
+
+  /** Class PartitionSpill
+   * The subgraphs are written one after the other in a temporary file (which is removed as soon as it is created, so it disappears when closed).
+   * For each subgraph, the file contains:
+   *   - the global-ids of its vertices, in the order of their local-ids.
+   *   - its edges (including those from r and to r') as pairs of local-ids.
+   * An index (in memory) keeps the position, the number of vertices and the number of edges of each subgraph.
+   *
+   * This class provides for the following:
+   *  - Writing subgraphs (vertices, then edges) one after the other. A subgraph ends where the next one begins.
+   *  - Reading back a subgraph as a (finalized) Subgraph.
+   */
+
+  class PartitionSpill{
+
+  public:
+
+    /** Constructor */
+    PartitionSpill();
+
+    /** Destructor: closes (and so removes) the temporary file. */
+    ~PartitionSpill();
+
+    /** Creates the temporary file in the given directory.
+     * @param dir directory in which the file is created.
+     * @return true on success, false if the file could not be created.
+     */
+    bool open(const std::string& dir);
+
+    /** Starts writing a new subgraph.
+     * @param globalIds pointer to the array of global-ids of the vertices of the subgraph (indexed by local-id).
+     * @param numVertices number of vertices of the subgraph (except r and r').
+     * @param acyclic true if the subgraph is made of singletons (they are written first).
+     */
+    void beginSubgraph(const int64_t* globalIds, int64_t numVertices, bool acyclic);
+
+    /** Writes an edge of the subgraph being written.
+     * @param u local-id of source vertex of edge
+     * @param v local-id of terminal vertex of edge
+     */
+    void addEdge(int64_t u, int64_t v);
+
+    /** Flushes the written subgraphs to the file.
+     * @return true on success, false on a write error (e.g. disk full).
+     */
+    bool flush();
+
+    /** Gives the number of subgraphs written. */
+    int64_t numSubgraphs();
+
+    /** Gives the number of subgraphs of singletons written (the first ones). */
+    int64_t numAcyclic();
+
+    /** Gives the number of vertices (except r and r') of the given subgraph. */
+    int64_t numVertices(int64_t sg);
+
+    /** Gives the number of edges of the given subgraph. */
+    int64_t numEdges(int64_t sg);
+
+    /** Reads back a subgraph.
+     * @param sg index of the subgraph (in the order in which they were written).
+     * @return pointer to a new finalized subgraph (to be deleted by the caller), or nullptr on a read error.
+     */
+    Subgraph* readSubgraph(int64_t sg);
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** type for the index entry of a subgraph */
+    struct Entry{
+      int64_t offset;      // position of the subgraph in the file
+      int64_t numVertices; // number of vertices (except r and r')
+      int64_t numEdges;    // number of edges
+    };
+
+    /** temporary file */
+    FILE* _file;
+
+    /** index of the subgraphs written so far */
+    std::vector<Entry> _index;
+
+    /** number of subgraphs of singletons written so far */
+    int64_t _numAcyclic;
+
+    /** number of bytes written so far */
+    int64_t _written;
+
+    /** buffer for the file */
+    char* _buffer;
+  };
+
+} // end namespace
+#endif
@@ -0,0 +1,163 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class Region
+ */
+#include "Region.hpp"
+
+#include <unordered_set>
+#include <algorithm>
+
+namespace supbub{
+
+  Region::Region(Graph& g, const std::vector<int64_t>& seeds, int64_t radius, int64_t maxVertices) {
+    // Breadth-first search from the seeds, one step (level) at a time, along the edges in both directions
+    std::unordered_set<int64_t> visited;
+    std::vector<int64_t> frontier;
+    std::vector<int64_t> next;
+    bool full = false;
+    auto visit = [&](int64_t v) {
+      if (maxVertices > 0 && int64_t(_vertices.size()) >= maxVertices) {
+	full = true;
+      }
+      else if (visited.insert(v).second) {
+	_vertices.push_back(v);
+	next.push_back(v);
+      }
+    };
+    for (int64_t seed : seeds) {
+      visit(seed);
+    }
+    for (int64_t step = 0; step < radius && !next.empty() && !full; ++step) {
+      frontier.swap(next);
+      next.clear();
+      for (int64_t u : frontier) {
+	int64_t_LIST children = g.getChildren(u);
+	for (int64_t_LIST_ITERATOR i = children.begin(); i != children.end(); ++i) {
+	  visit(*i);
+	}
+	int64_t_LIST parents = g.getParents(u);
+	for (int64_t_LIST_ITERATOR i = parents.begin(); i != parents.end(); ++i) {
+	  visit(*i);
+	}
+      }
+    }
+    visited.clear();
+
+    // Region graph: local ids in the order of the ids of the graph, X last
+    std::sort(_vertices.begin(), _vertices.end());
+    int64_t numLocal = _vertices.size();
+    int64_t x = numLocal;
+    std::vector<int64_t> tails;
+    std::vector<int64_t> heads;
+    _numEdges = 0;
+    for (int64_t l = 0; l < numLocal; ++l) {
+      int64_t v = _vertices[l];
+      bool toOutside = false;
+      int64_t_LIST children = g.getChildren(v);
+      for (int64_t_LIST_ITERATOR i = children.begin(); i != children.end(); ++i) {
+	int64_t w = localId(*i);
+	if (w >= 0) {
+	  tails.push_back(l);
+	  heads.push_back(w);
+	  _numEdges++;
+	}
+	else {
+	  toOutside = true;
+	}
+      }
+      if (toOutside) { // edge l-X (once)
+	tails.push_back(l);
+	heads.push_back(x);
+      }
+      int64_t_LIST parents = g.getParents(v);
+      for (int64_t_LIST_ITERATOR i = parents.begin(); i != parents.end(); ++i) {
+	if (localId(*i) < 0) { // edge X-l (once)
+	  tails.push_back(x);
+	  heads.push_back(l);
+	  break;
+	}
+      }
+    }
+    _vertices.push_back(-1);
+    _graph = new Graph(numLocal + 1);
+    _graph->addEdges(tails, heads);
+    _graph->finalize();
+    _numParts = 0;
+    _numComplete = 0;
+    markStage("region");
+  }
+
+  Region::~Region() {
+    delete _graph;
+  }
+
+  int64_t
+  Region::localId(int64_t v){
+    std::vector<int64_t>::iterator i = std::lower_bound(_vertices.begin(), _vertices.end(), v);
+    return (i != _vertices.end() && *i == v) ? i - _vertices.begin() : -1;
+  }
+
+  void
+  Region::find(DetectSuperBubble& dsb, DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList){
+    int64_t numLocal = _graph->numVertices();
+    int64_t x = numLocal - 1;
+    int64_t* part = new int64_t[numLocal];
+    bool* selected = new bool[numLocal]();
+    memoryChanged(MEM_PARTITION, (sizeof(int64_t) + sizeof(bool)) * numLocal);
+    dsb.findParts(*_graph, part);
+
+    // Incomplete parts (marked at their smallest vertex first): the part of X, and the components of singletons with an edge to the scc of X
+    for (int64_t v = 0; v < numLocal; ++v) {
+      if (part[v] == part[x]) {
+	selected[DetectSuperBubble::smallestOfPart(part[v])] = true;
+      }
+      else if (part[v] >= 0) {
+	int64_t_LIST children = _graph->getChildren(v);
+	int64_t_LIST parents = _graph->getParents(v);
+	for (int64_t_LIST_ITERATOR i = children.begin(); i != children.end(); ++i) {
+	  selected[part[v]] = selected[part[v]] || (part[*i] == part[x]);
+	}
+	for (int64_t_LIST_ITERATOR i = parents.begin(); i != parents.end(); ++i) {
+	  selected[part[v]] = selected[part[v]] || (part[*i] == part[x]);
+	}
+      }
+    }
+    // then the complete parts are selected, and each vertex takes the value of its part
+    for (int64_t v = 0; v < numLocal; ++v) {
+      if (DetectSuperBubble::smallestOfPart(part[v]) == v) {
+	selected[v] = !selected[v];
+	_numParts++;
+	_numComplete += selected[v] ? 1 : 0;
+      }
+      else {
+	selected[v] = selected[DetectSuperBubble::smallestOfPart(part[v])]; // (the smallest vertex of a part comes first)
+      }
+    }
+
+    dsb.findInParts(*_graph, part, selected, superBubblesList);
+    for (DetectSuperBubble::SuperBubble& bubble : superBubblesList) {
+      bubble.entrance = _vertices[bubble.entrance];
+      bubble.exit = _vertices[bubble.exit];
+      if (bubble.parent >= 0) {
+	bubble.parent = _vertices[bubble.parent];
+      }
+    }
+    delete[] part;
+    delete[] selected;
+    memoryChanged(MEM_PARTITION, -int64_t(sizeof(int64_t) + sizeof(bool)) * numLocal);
+  }
+
+} // end namespace
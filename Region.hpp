@@ -0,0 +1,99 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class Region.
+ * It is the part of a graph around some seed vertices (option --seeds), in which superbubbles are found without processing the whole graph.
+ */
+
+#ifndef REGION_HPP
+#define REGION_HPP
+
+#include "globalDefs.hpp"
+#include "Graph.hpp"
+#include "DetectSuperBubble.hpp"
+
+namespace supbub{
+
+  /** Class Region
+   * The region is made of the vertices found by a breadth-first search from the seeds, along the edges in both directions, up to a number of steps (radius) or of vertices.
+   * It is copied into a graph of its own (local ids given in the order of the ids of the graph) with one more vertex, X, standing for all the vertices outside the region:
+   * an edge leaving (entering) the region is an edge to (from) X, as the partitioner attaches a vertex with an edge to another subgraph to r' (r).
+   *
+   * The sccs of the region graph not containing X are exactly sccs of the graph (a cycle going out of the region goes through X), and so are its singletons outside the scc of X.
+   * A part (see DetectSuperBubble::findParts) of the region graph is complete if it is a part of the graph: an scc not containing X, or a weakly connected component of such singletons with no edge to X or to the scc of X.
+   * The superbubbles are found in the complete parts only: each of them is then built as it is by find() on the whole graph, so that its superbubbles are exactly those of the whole graph in it.
+   * The superbubbles of the other parts are not given (the larger the region, the more parts are complete).
+   *
+   * This class provides for the following:
+   *  - Extracting the region around the seeds.
+   *  - Finding the superbubbles of its complete parts, with the ids of the graph.
+   */
+
+  class Region{
+
+  public:
+
+    /** Constructor: extracts the region.
+     * @param g reference to the (finalized) graph.
+     * @param seeds reference to the seed vertices (valid ids of g).
+     * @param radius largest number of edges between a vertex of the region and the nearest seed.
+     * @param maxVertices largest number of vertices of the region (0 for no bound): the search stops when it is reached.
+     */
+    Region(Graph& g, const std::vector<int64_t>& seeds, int64_t radius, int64_t maxVertices);
+
+    /** Destructor */
+    ~Region();
+
+    /** Gives the number of vertices of the region (X excluded). */
+    int64_t numVertices() { return _vertices.size(); }
+
+    /** Gives the number of edges between vertices of the region. */
+    int64_t numEdges() { return _numEdges; }
+
+    /** Gives the number of parts of the region graph and how many of them are complete (once find() has been called). */
+    int64_t numParts() { return _numParts; }
+    int64_t numComplete() { return _numComplete; }
+
+    /** Gives the ids in the graph of the vertices of the region graph (X has id -1). */
+    const int64_t* globalIds() { return _vertices.data(); }
+
+    /** Finds the superbubbles of the complete parts of the region.
+     * @param dsb reference to the detector (its option originalIds, if set, is to translate the local ids of the region graph).
+     * @param superBubblesList reference to list of superbubbles in which result is to be returned, with the ids of the graph (sorted by entrance unless the option unordered of dsb is set).
+     */
+    void find(DetectSuperBubble& dsb, DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList);
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** vertices of the region (sorted), followed by -1 for X: vertex l of the region graph is _vertices[l] of the graph */
+    std::vector<int64_t> _vertices;
+
+    /** region graph (vertex numVertices() is X) */
+    Graph* _graph;
+
+    /** number of edges between vertices of the region */
+    int64_t _numEdges;
+
+    /** numbers of parts and of complete parts of the region graph */
+    int64_t _numParts;
+    int64_t _numComplete;
+
+    /** Gives the local id of a vertex of the graph, -1 if it is not in the region. */
+    int64_t localId(int64_t v);
+  };
+
+} // end namespace
+#endif
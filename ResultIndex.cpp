@@ -0,0 +1,177 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class ResultIndex
+ */
+#include "ResultIndex.hpp"
+#include "MemoryStats.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace supbub{
+
+  /* magic string at the start of an index file */
+  static const char INDEX_MAGIC[8] = {'S', 'U', 'P', 'B', 'U', 'B', 'I', 'X'};
+
+  /* number of values written at once */
+  static const int64_t INDEX_CHUNK = 4096;
+
+  /* Writes n values, value k being get(k). */
+  template<class GET>
+  static bool
+  writeColumn(FILE* file, int64_t n, GET get){
+    int64_t chunk[INDEX_CHUNK];
+    for (int64_t first = 0; first < n; first += INDEX_CHUNK) {
+      int64_t size = std::min(INDEX_CHUNK, n - first);
+      for (int64_t k = 0; k < size; ++k) {
+	chunk[k] = get(first + k);
+      }
+      if (fwrite(chunk, sizeof(int64_t), size, file) != size_t(size)) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  bool
+  ResultIndex::write(const std::string& filename, const DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList, int64_t numVertices, const int64_t* originalIds){
+    typedef std::pair<int64_t, int64_t> BUBBLE;
+    int64_t n = superBubblesList.size();
+    std::vector<BUBBLE> byEntrance;
+    std::vector<BUBBLE> byExit;
+    byEntrance.reserve(n);
+    byExit.reserve(n);
+    memoryChanged(MEM_RESULTS, 2 * sizeof(BUBBLE) * n);
+    for (auto i = superBubblesList.begin(); i != superBubblesList.end(); ++i) {
+      int64_t entranceId = (originalIds == nullptr) ? (*i).entrance : originalIds[(*i).entrance];
+      int64_t exitId = (originalIds == nullptr) ? (*i).exit : originalIds[(*i).exit];
+      byEntrance.push_back(BUBBLE(entranceId, exitId));
+      byExit.push_back(BUBBLE(exitId, entranceId));
+    }
+    if (!std::is_sorted(byEntrance.begin(), byEntrance.end())) { // (already sorted unless the results are unordered)
+      std::sort(byEntrance.begin(), byEntrance.end());
+    }
+    std::sort(byExit.begin(), byExit.end());
+
+    bool written = false;
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (file != nullptr) {
+      Header header;
+      memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+      header.numVertices = numVertices;
+      header.numSuperBubbles = n;
+      written = (fwrite(&header, sizeof(Header), 1, file) == 1
+		 && writeColumn(file, n, [&](int64_t k) { return byEntrance[k].first; })
+		 && writeColumn(file, n, [&](int64_t k) { return byEntrance[k].second; })
+		 && writeColumn(file, n, [&](int64_t k) { return byExit[k].first; })
+		 && writeColumn(file, n, [&](int64_t k) { return byExit[k].second; }));
+      written = (fclose(file) == 0 && written);
+    }
+    memoryChanged(MEM_RESULTS, -int64_t(2 * sizeof(BUBBLE)) * n);
+    return written;
+  }
+
+  ResultIndex::ResultIndex() {
+    _map = nullptr;
+    _mapBytes = 0;
+    _numVertices = 0;
+    _numSuperBubbles = 0;
+    _entrances = nullptr;
+    _exits = nullptr;
+    _exitsSorted = nullptr;
+    _entrancesByExit = nullptr;
+  }
+
+  ResultIndex::~ResultIndex() {
+    close();
+  }
+
+  bool
+  ResultIndex::open(const std::string& filename){
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(Header)) {
+      ::close(fd);
+      return false;
+    }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // (the mapping stays valid)
+    if (map == MAP_FAILED) {
+      return false;
+    }
+    const Header* header = static_cast<const Header*>(map);
+    int64_t n = header->numSuperBubbles;
+    if (memcmp(header->magic, INDEX_MAGIC, sizeof(header->magic)) != 0 || n < 0
+	|| size_t(st.st_size) != sizeof(Header) + 4 * sizeof(int64_t) * size_t(n)) {
+      munmap(map, st.st_size);
+      return false;
+    }
+    _map = map;
+    _mapBytes = st.st_size;
+    _numVertices = header->numVertices;
+    _numSuperBubbles = n;
+    _entrances = reinterpret_cast<const int64_t*>(header + 1);
+    _exits = _entrances + n;
+    _exitsSorted = _exits + n;
+    _entrancesByExit = _exitsSorted + n;
+    return true;
+  }
+
+  void
+  ResultIndex::close(){
+    if (_map != nullptr) {
+      munmap(_map, _mapBytes);
+    }
+    _map = nullptr;
+    _mapBytes = 0;
+    _numVertices = 0;
+    _numSuperBubbles = 0;
+    _entrances = nullptr;
+    _exits = nullptr;
+    _exitsSorted = nullptr;
+    _entrancesByExit = nullptr;
+  }
+
+  int64_t
+  ResultIndex::exitOf(int64_t v){
+    int64_t k = lowerBoundEntrance(v);
+    return (k < _numSuperBubbles && _entrances[k] == v) ? _exits[k] : -1;
+  }
+
+  int64_t
+  ResultIndex::entranceOf(int64_t v){
+    int64_t k = lowerBoundExit(v);
+    return (k < _numSuperBubbles && _exitsSorted[k] == v) ? _entrancesByExit[k] : -1;
+  }
+
+  int64_t
+  ResultIndex::lowerBoundEntrance(int64_t v){
+    return std::lower_bound(_entrances, _entrances + _numSuperBubbles, v) - _entrances;
+  }
+
+  int64_t
+  ResultIndex::lowerBoundExit(int64_t v){
+    return std::lower_bound(_exitsSorted, _exitsSorted + _numSuperBubbles, v) - _exitsSorted;
+  }
+
+} // end namespace
@@ -0,0 +1,140 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class ResultIndex.
+ * It writes the superbubbles found in a binary index file, and answers lookups by vertex on such a file without reading it whole.
+ */
+
+#ifndef RESULT_INDEX_HPP
+#define RESULT_INDEX_HPP
+
+#include "globalDefs.hpp"
+#include "DetectSuperBubble.hpp"
+
+namespace supbub{
+
+  /** Class ResultIndex
+   * The index file holds, after a header (magic "SUPBUBIX", number of vertices, number of superbubbles n), four arrays of n 64-bit integers (native byte order):
+   *   - the entrances, sorted.
+   *   - the exits, in the order of the entrances.
+   *   - the exits, sorted.
+   *   - the entrances, in the order of the exits.
+   * The file is memory-mapped when opened: a lookup is a binary search over the pages it touches, so that queries do not need the whole file in memory.
+   *
+   * This class provides for the following:
+   *  - Writing the index of a list of superbubbles.
+   *  - Finding the superbubble starting or ending at a vertex.
+   *  - Finding the superbubbles whose entrance (or exit) is in a range of vertices.
+   */
+
+  class ResultIndex{
+
+  public:
+
+    /** Writes the index of the given superbubbles (in any order).
+     * @param filename name of the file to be written.
+     * @param superBubblesList reference to the list of superbubbles.
+     * @param numVertices number of vertices of the graph.
+     * @param originalIds if not null, the ids are translated (originalIds[v] is written for vertex v of the graph), e.g. back to the ids of a sparse input.
+     * @return true on success, false on a write error.
+     */
+    static bool write(const std::string& filename, const DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList, int64_t numVertices, const int64_t* originalIds);
+
+    /** Constructor */
+    ResultIndex();
+
+    /** Destructor: unmaps the file. */
+    ~ResultIndex();
+
+    /** Maps an index file.
+     * @param filename name of the file.
+     * @return true on success, false if the file cannot be read or is not an index.
+     */
+    bool open(const std::string& filename);
+
+    /** Unmaps the file (if any). */
+    void close();
+
+    /** Gives the number of vertices of the graph. */
+    inline int64_t numVertices(){
+      return _numVertices;
+    }
+
+    /** Gives the number of superbubbles. */
+    inline int64_t numSuperBubbles(){
+      return _numSuperBubbles;
+    }
+
+    /** Gives the exit of the superbubble starting at vertex v, -1 if none. */
+    int64_t exitOf(int64_t v);
+
+    /** Gives the entrance of the superbubble ending at vertex v, -1 if none. */
+    int64_t entranceOf(int64_t v);
+
+    /** Gives the rank, in the order of entrances, of the first superbubble whose entrance is at least v (numSuperBubbles() if none).
+     * The superbubbles with entrance in [u, v) are those of rank in [lowerBoundEntrance(u), lowerBoundEntrance(v)).
+     */
+    int64_t lowerBoundEntrance(int64_t v);
+
+    /** Gives the rank, in the order of exits, of the first superbubble whose exit is at least v (numSuperBubbles() if none). */
+    int64_t lowerBoundExit(int64_t v);
+
+    /** Gives the entrance of the superbubble of rank k in the order of entrances. */
+    inline int64_t entranceAt(int64_t k){
+      return _entrances[k];
+    }
+
+    /** Gives the exit of the superbubble of rank k in the order of entrances. */
+    inline int64_t exitAt(int64_t k){
+      return _exits[k];
+    }
+
+    /** Gives the exit of the superbubble of rank k in the order of exits. */
+    inline int64_t exitByExitAt(int64_t k){
+      return _exitsSorted[k];
+    }
+
+    /** Gives the entrance of the superbubble of rank k in the order of exits. */
+    inline int64_t entranceByExitAt(int64_t k){
+      return _entrancesByExit[k];
+    }
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** type for the header of the file */
+    struct Header{
+      char magic[8];           // "SUPBUBIX"
+      int64_t numVertices;     // number of vertices of the graph
+      int64_t numSuperBubbles; // number of superbubbles
+    };
+
+    /** mapped file (nullptr if none) and its size in bytes */
+    void* _map;
+    size_t _mapBytes;
+
+    /** numbers read from the header */
+    int64_t _numVertices;
+    int64_t _numSuperBubbles;
+
+    /** the arrays of the file (pointers into the mapping) */
+    const int64_t* _entrances;
+    const int64_t* _exits;
+    const int64_t* _exitsSorted;
+    const int64_t* _entrancesByExit;
+  };
+
+} // end namespace
+#endif
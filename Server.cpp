@@ -0,0 +1,403 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class Server
+ */
+#include "Server.hpp"
+#include "helperDefs.hpp"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+
+namespace supbub{
+
+  /* size of the buffer of the requests received */
+  static const size_t RECEIVE_BUFFER_SIZE = 1 << 16;
+
+  /* size from which an answer being built is sent before it is complete */
+  static const size_t SEND_CHUNK_SIZE = 1 << 20;
+
+  /* Counts the vertices of each part (at its smallest vertex, 0 elsewhere). */
+  static void
+  countParts(const int64_t* part, int64_t numVertices, int64_t* partSize){
+    std::fill_n(partSize, numVertices, 0);
+    for (int64_t v = 0; v < numVertices; ++v) {
+      partSize[DetectSuperBubble::smallestOfPart(part[v])]++;
+    }
+  }
+
+  /* Releases a list of superbubbles found (whose elements have been copied), and its memory accounted by the detection. */
+  static void
+  releaseFound(DetectSuperBubble::SUPERBUBBLE_LIST& found){
+    memoryChanged(MEM_RESULTS, -int64_t(sizeof(DetectSuperBubble::SuperBubble) + 2 * sizeof(void*)) * found.size());
+    found.clear();
+  }
+
+  /* Options of the detection used by the server: superbubbles sorted by entrance, nothing written. */
+  static DetectSuperBubble::Options
+  serverOptions(DetectSuperBubble::Options options){
+    options.interiorVertices = nullptr;
+    options.hierarchy = false;
+    options.unordered = false;
+    return options;
+  }
+
+  /* Sends all the given bytes (false if the connection is broken). */
+  static bool
+  sendAll(int fd, const std::string& data){
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (n == -1 && errno == EINTR) {
+	continue;
+      }
+      if (n <= 0) {
+	return false;
+      }
+      sent += n;
+    }
+    return true;
+  }
+
+  Server::Server(Graph* graph, DetectSuperBubble::Options options, bool dropSelfLoops) : _detector(serverOptions(options)) {
+    _graph = graph;
+    _sizes = options.interiorSizes;
+    _numThreads = options.numThreads;
+    _dropSelfLoops = dropSelfLoops;
+    _trackedBytes = 0;
+    int64_t numVertices = _graph->numVertices();
+    _part = new int64_t[numVertices];
+    _partSize = new int64_t[numVertices];
+    memoryChanged(MEM_PARTITION, sizeof(int64_t) * 2 * numVertices);
+    _detector.findParts(*_graph, _part);
+    countParts(_part, numVertices, _partSize);
+
+    DetectSuperBubble::SUPERBUBBLE_LIST found;
+    _detector.findInParts(*_graph, _part, nullptr, found);
+    _results.assign(found.begin(), found.end());
+    releaseFound(found);
+    indexResults();
+  }
+
+  Server::~Server() {
+    memoryChanged(MEM_PARTITION, -int64_t(sizeof(int64_t)) * 2 * _graph->numVertices());
+    memoryChanged(MEM_RESULTS, -_trackedBytes);
+    delete[] _part;
+    delete[] _partSize;
+    delete _graph;
+  }
+
+  int64_t
+  Server::numSuperBubbles(){
+    return _results.size();
+  }
+
+  void
+  Server::indexResults(){
+    _byExit.resize(_results.size());
+    for (size_t i = 0; i < _results.size(); ++i) {
+      _byExit[i] = i;
+    }
+    std::sort(_byExit.begin(), _byExit.end(), [this](int64_t a, int64_t b) { return _results[a].exit < _results[b].exit; });
+    int64_t bytes = sizeof(DetectSuperBubble::SuperBubble) * _results.capacity() + sizeof(int64_t) * _byExit.capacity();
+    memoryChanged(MEM_RESULTS, bytes - _trackedBytes);
+    _trackedBytes = bytes;
+  }
+
+  bool
+  Server::run(const char* socketPath){
+    struct sockaddr_un address;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+      fprintf(stderr, "Socket path too long: %s \n", socketPath);
+      return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1) {
+      fprintf(stderr, "Cannot create socket: %s \n", strerror(errno));
+      return false;
+    }
+    struct stat status;
+    if (lstat(socketPath, &status) == 0 && S_ISSOCK(status.st_mode)) { // left by a previous server
+      unlink(socketPath);
+    }
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) == -1 || listen(listener, SOMAXCONN) == -1) {
+      fprintf(stderr, "Cannot listen on socket %s: %s \n", socketPath, strerror(errno));
+      close(listener);
+      return false;
+    }
+    fprintf(stderr, "Serving %ld superbubbles on %s \n", (long)_results.size(), socketPath);
+
+    // one client at a time: the requests of a client see the graph as edited by the previous ones
+    bool shutdown = false;
+    bool failed = false;
+    while (!shutdown && !failed) {
+      int fd = accept(listener, nullptr, nullptr);
+      if (fd == -1) {
+	if (errno == EINTR || errno == ECONNABORTED) {
+	  continue;
+	}
+	fprintf(stderr, "Cannot accept connection: %s \n", strerror(errno));
+	failed = true;
+	continue;
+      }
+      shutdown = serveClient(fd);
+      close(fd);
+    }
+    close(listener);
+    unlink(socketPath);
+    return shutdown;
+  }
+
+  bool
+  Server::serveClient(int fd){
+    std::vector<Edit> edits;
+    std::string received; // requests received and not answered yet (the last one may be incomplete)
+    std::string reply;
+    char buffer[RECEIVE_BUFFER_SIZE];
+    while (true) {
+      ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+      if (n == -1 && errno == EINTR) {
+	continue;
+      }
+      if (n <= 0) { // connection ended
+	return false;
+      }
+      received.append(buffer, n);
+      size_t begin = 0;
+      size_t end;
+      while ((end = received.find('\n', begin)) != std::string::npos) {
+	std::string request = received.substr(begin, end - begin);
+	begin = end + 1;
+	std::string command;
+	std::istringstream(request) >> command;
+	if (command.empty()) { // empty line
+	  continue;
+	}
+	if (command == "quit") {
+	  return false;
+	}
+	bool shutdown = answer(fd, request, edits, reply);
+	if (!sendAll(fd, reply)) {
+	  return false;
+	}
+	reply.clear();
+	if (shutdown) {
+	  return true;
+	}
+      }
+      received.erase(0, begin);
+    }
+  }
+
+  bool
+  Server::answer(int fd, const std::string& request, std::vector<Edit>& edits, std::string& reply){
+    std::istringstream in(request);
+    std::string command;
+    in >> command;
+    int numArguments = 0;
+    if (command == "add" || command == "remove") {
+      numArguments = 2;
+    }
+    else if (command == "scc" || command == "entrance" || command == "exit") {
+      numArguments = 1;
+    }
+    int64_t arguments[2];
+    for (int a = 0; a < numArguments; ++a) {
+      if (!(in >> arguments[a]) || arguments[a] < 0 || arguments[a] >= _graph->numVertices()) {
+	reply += "error invalid vertex\n";
+	return false;
+      }
+    }
+
+    if (command == "results") {
+      reply += "ok " + std::to_string(_results.size()) + "\n";
+      for (const DetectSuperBubble::SuperBubble& bubble : _results) {
+	appendResult(reply, bubble);
+	if (reply.size() >= SEND_CHUNK_SIZE) {
+	  sendAll(fd, reply); // (a broken connection is found out by the next receive)
+	  reply.clear();
+	}
+      }
+    }
+    else if (command == "scc") {
+      int64_t part = _part[arguments[0]];
+      std::vector<const DetectSuperBubble::SuperBubble*> inPart;
+      for (const DetectSuperBubble::SuperBubble& bubble : _results) {
+	if (_part[bubble.entrance] == part) {
+	  inPart.push_back(&bubble);
+	}
+      }
+      reply += "ok " + std::to_string(inPart.size()) + "\n";
+      for (const DetectSuperBubble::SuperBubble* bubble : inPart) {
+	appendResult(reply, *bubble);
+      }
+    }
+    else if (command == "entrance") {
+      auto i = std::lower_bound(_results.begin(), _results.end(), arguments[0],
+				[](const DetectSuperBubble::SuperBubble& bubble, int64_t v) { return bubble.entrance < v; });
+      bool found = (i != _results.end() && i->entrance == arguments[0]);
+      reply += found ? "ok 1\n" : "ok 0\n";
+      if (found) {
+	appendResult(reply, *i);
+      }
+    }
+    else if (command == "exit") {
+      auto i = std::lower_bound(_byExit.begin(), _byExit.end(), arguments[0],
+				[this](int64_t position, int64_t v) { return _results[position].exit < v; });
+      bool found = (i != _byExit.end() && _results[*i].exit == arguments[0]);
+      reply += found ? "ok 1\n" : "ok 0\n";
+      if (found) {
+	appendResult(reply, _results[*i]);
+      }
+    }
+    else if (command == "add" || command == "remove") {
+      edits.push_back(Edit{arguments[0], arguments[1], command == "add"});
+      reply += "ok 0\n";
+    }
+    else if (command == "commit") {
+      double start = gettime();
+      int64_t numProcessed = commit(edits);
+      edits.clear();
+      std::ostringstream line;
+      line << _results.size() << " " << numProcessed << " " << (gettime() - start) << "\n";
+      reply += "ok 1\n" + line.str();
+    }
+    else if (command == "shutdown") {
+      reply += "ok 0\n";
+      return true;
+    }
+    else {
+      reply += "error unknown request: " + command + "\n";
+    }
+    return false;
+  }
+
+  int64_t
+  Server::commit(const std::vector<Edit>& edits){
+    int64_t numVertices = _graph->numVertices();
+
+    // the last edit of each edge prevails: sorted by edge (in the order recorded for an edge), then the last one of each edge kept
+    std::vector<Edit> sorted(edits);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Edit& a, const Edit& b) { return a.u < b.u || (a.u == b.u && a.v < b.v); });
+    std::vector<Edit> last;
+    for (size_t e = 0; e < sorted.size(); ++e) {
+      if (e + 1 == sorted.size() || sorted[e + 1].u != sorted[e].u || sorted[e + 1].v != sorted[e].v) {
+	last.push_back(sorted[e]);
+      }
+    }
+    bool* edited = new bool[numVertices](); // ends of the edited edges
+    for (const Edit& e : last) {
+      edited[e.u] = edited[e.v] = true;
+    }
+
+    // edges of the edited graph: those not removed, then those added (duplicates are collapsed when finalized)
+    std::vector<int64_t> tails;
+    std::vector<int64_t> heads;
+    tails.reserve(_graph->numEdges() + last.size());
+    heads.reserve(_graph->numEdges() + last.size());
+    for (int64_t u = 0; u < numVertices; ++u) {
+      int64_t_LIST children = _graph->getChildren(u);
+      for (int64_t_LIST_ITERATOR i = children.begin(); i != children.end(); ++i) {
+	if (edited[u]) {
+	  auto e = std::lower_bound(last.begin(), last.end(), Edit{u, *i, false},
+				    [](const Edit& a, const Edit& b) { return a.u < b.u || (a.u == b.u && a.v < b.v); });
+	  if (e != last.end() && e->u == u && e->v == *i && !e->add) { // removed
+	    continue;
+	  }
+	}
+	tails.push_back(u);
+	heads.push_back(*i);
+      }
+    }
+    for (const Edit& e : last) {
+      if (e.add) {
+	tails.push_back(e.u);
+	heads.push_back(e.v);
+      }
+    }
+    Graph* graph = new Graph(numVertices);
+    graph->addEdges(tails, heads);
+    graph->finalizeUnique(_numThreads, _dropSelfLoops);
+    delete _graph;
+    _graph = graph;
+
+    // A part is processed again unless it is left as it was: the same vertices (they had the same part, as large), none of them an end of an edited edge.
+    int64_t* part = new int64_t[numVertices];
+    int64_t* partSize = new int64_t[numVertices];
+    memoryChanged(MEM_PARTITION, sizeof(int64_t) * 2 * numVertices);
+    _detector.findParts(*_graph, part);
+    countParts(part, numVertices, partSize);
+    bool* selected = new bool[numVertices](); // first at the smallest vertex of each part only
+    for (int64_t v = 0; v < numVertices; ++v) {
+      if (edited[v] || part[v] != _part[v]) {
+	selected[DetectSuperBubble::smallestOfPart(part[v])] = true;
+      }
+    }
+    int64_t numProcessed = 0;
+    for (int64_t v = 0; v < numVertices; ++v) {
+      if (DetectSuperBubble::smallestOfPart(part[v]) == v) {
+	selected[v] = selected[v] || (partSize[v] != _partSize[v]);
+	numProcessed += selected[v] ? 1 : 0;
+      }
+      else {
+	selected[v] = selected[DetectSuperBubble::smallestOfPart(part[v])]; // (the smallest vertex of a part comes first)
+      }
+    }
+    delete[] edited;
+
+    // the superbubbles of the parts left as they were are kept, those of the others found again
+    _results.erase(std::remove_if(_results.begin(), _results.end(), [selected](const DetectSuperBubble::SuperBubble& bubble) { return selected[bubble.entrance]; }),
+		   _results.end());
+    DetectSuperBubble::SUPERBUBBLE_LIST found;
+    if (numProcessed > 0) {
+      _detector.findInParts(*_graph, part, selected, found);
+    }
+    std::vector<DetectSuperBubble::SuperBubble> merged;
+    merged.reserve(_results.size() + found.size());
+    std::merge(_results.begin(), _results.end(), found.begin(), found.end(), std::back_inserter(merged),
+	       [](const DetectSuperBubble::SuperBubble& a, const DetectSuperBubble::SuperBubble& b) { return a.entrance < b.entrance; });
+    _results.swap(merged);
+    releaseFound(found);
+    indexResults();
+
+    delete[] selected;
+    delete[] _part;
+    delete[] _partSize;
+    memoryChanged(MEM_PARTITION, -int64_t(sizeof(int64_t)) * 2 * numVertices);
+    _part = part;
+    _partSize = partSize;
+    return numProcessed;
+  }
+
+  void
+  Server::appendResult(std::string& reply, const DetectSuperBubble::SuperBubble& bubble){
+    reply += "<" + std::to_string(bubble.entrance) + "," + std::to_string(bubble.exit) + ">";
+    if (_sizes) {
+      reply += " " + std::to_string(bubble.numVertices) + " " + std::to_string(bubble.numEdges);
+    }
+    reply += "\n";
+  }
+
+} // end namespace
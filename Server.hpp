@@ -0,0 +1,142 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class Server.
+ * It keeps a graph and its superbubbles in memory and answers requests on them over a unix domain socket (option --serve), edits of the graph included.
+ */
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "globalDefs.hpp"
+#include "Graph.hpp"
+#include "DetectSuperBubble.hpp"
+
+namespace supbub{
+
+  /** Class Server
+   * The graph is read once; its parts (see DetectSuperBubble::findParts) and its superbubbles (sorted by entrance, and indexed by exit) are kept from one request to the next.
+   * Edits are recorded by each client and applied together when it commits them: the graph is rebuilt and its parts found again,
+   * but only the parts which are not left as they were are processed again (the superbubbles of the others are kept).
+   *
+   * Requests are lines of text, one at a time; the answer to each is a line "ok <n>" followed by n lines, or a line "error <message>":
+   *  - results: all superbubbles, one per line (as in the output file).
+   *  - scc <v>: the superbubbles of the part of v (its scc, or its weakly connected component of singletons).
+   *  - entrance <v>, exit <v>: the superbubble with entrance (exit) v, if any.
+   *  - add <u> <v>, remove <u> <v>: records the addition (removal) of edge u-v.
+   *  - commit: applies the edits recorded, then gives one line: number of superbubbles, number of parts processed again, time taken (secs).
+   *  - quit: ends the connection (the edits not committed are dropped); shutdown: stops the server.
+   *
+   * This class provides for the following:
+   *  - Finding the superbubbles of the graph and keeping them.
+   *  - Listening on a socket and answering the requests of the clients, one client after the other.
+   */
+
+  class Server{
+
+  public:
+
+    /** Constructor: finds the parts and the superbubbles of the graph.
+     * @param graph pointer to the (finalized) graph, owned by the server from then on.
+     * @param options options controlling the detection (interiorVertices, hierarchy and unordered are not used).
+     * @param dropSelfLoops true if the self-loops added by edits are to be removed.
+     */
+    Server(Graph* graph, DetectSuperBubble::Options options, bool dropSelfLoops);
+
+    /** Destructor */
+    ~Server();
+
+    /** Number of superbubbles of the graph. */
+    int64_t numSuperBubbles();
+
+    /** Listens on a unix domain socket and answers the requests of the clients until one of them asks for a shutdown.
+     * @param socketPath path of the socket (a socket left there by a previous server is replaced; removed on shutdown).
+     * @return false if the socket cannot be set up (the error is written on stderr), true after a shutdown.
+     */
+    bool run(const char* socketPath);
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** type for an edit recorded by a client */
+    struct Edit{
+      int64_t u;  // tail of the edge
+      int64_t v;  // head of the edge
+      bool add;   // true for an addition, false for a removal
+    };
+
+    /** graph (as edited so far) */
+    Graph* _graph;
+
+    /** part of each vertex (see DetectSuperBubble::findParts) */
+    int64_t* _part;
+
+    /** number of vertices of each part (at its smallest vertex, 0 elsewhere) */
+    int64_t* _partSize;
+
+    /** superbubbles of the graph, sorted by entrance */
+    std::vector<DetectSuperBubble::SuperBubble> _results;
+
+    /** positions in _results sorted by exit */
+    std::vector<int64_t> _byExit;
+
+    /** detector of superbubbles (its workspaces are kept from one commit to the next) */
+    DetectSuperBubble _detector;
+
+    /** true if the numbers of vertices and edges of the superbubbles are written */
+    bool _sizes;
+
+    /** number of threads rebuilding the graph */
+    int _numThreads;
+
+    /** true if the self-loops added by edits are removed */
+    bool _dropSelfLoops;
+
+    /** number of bytes of _results and _byExit accounted so far */
+    int64_t _trackedBytes;
+
+    /** Indexes _results by exit and accounts the memory of both. */
+    void indexResults();
+
+    /** Answers the requests of one client until it ends the connection.
+     * @param fd descriptor of the connection.
+     * @return true if the client asked for a shutdown.
+     */
+    bool serveClient(int fd);
+
+    /** Answers one request.
+     * @param fd descriptor of the connection.
+     * @param request the request (a line without its end).
+     * @param edits reference to the edits recorded by the client.
+     * @param reply reference to the string to which the answer is appended (sent on the way if it grows large).
+     * @return true if the request is a shutdown.
+     */
+    bool answer(int fd, const std::string& request, std::vector<Edit>& edits, std::string& reply);
+
+    /** Applies edits to the graph and updates the superbubbles.
+     * @param edits reference to the edits (in the order recorded: the last one on an edge prevails).
+     * @return number of parts processed again.
+     */
+    int64_t commit(const std::vector<Edit>& edits);
+
+    /** Appends the line of a superbubble to a reply.
+     * @param reply reference to the reply.
+     * @param bubble reference to the superbubble.
+     */
+    void appendResult(std::string& reply, const DetectSuperBubble::SuperBubble& bubble);
+  };
+
+} // end namespace
+#endif
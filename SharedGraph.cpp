@@ -0,0 +1,162 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class SharedGraph
+ */
+#include "SharedGraph.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace supbub{
+
+  /* magic string at the start of a segment */
+  static const char GRAPH_MAGIC[8] = {'S', 'U', 'P', 'B', 'U', 'B', 'G', 'R'};
+
+  /* Copies the adjacency lists of g (children or parents) in compressed sparse row form: start (n + 1 entries), then ids.
+   * Returns the position following the ids. */
+  template<class GET_LIST>
+  static int64_t*
+  copyAdjacency(Graph& g, int64_t* start, GET_LIST getList){
+    int64_t numVertices = g.numVertices();
+    int64_t* ids = start + numVertices + 1;
+    start[0] = 0;
+    for (int64_t v = 0; v < numVertices; ++v) {
+      int64_t_LIST list = getList(v);
+      std::copy(list.begin(), list.end(), ids + start[v]);
+      start[v + 1] = start[v] + list.size();
+    }
+    return ids + start[numVertices];
+  }
+
+  std::string
+  SharedGraph::segmentName(const char* name){
+    return (name[0] == '/') ? std::string(name) : "/" + std::string(name);
+  }
+
+  size_t
+  SharedGraph::segmentBytes(int64_t numVertices, int64_t numEdges, bool originalIds){
+    return sizeof(Header) + sizeof(int64_t) * size_t(2 * (numVertices + 1) + 2 * numEdges + (originalIds ? numVertices : 0));
+  }
+
+  bool
+  SharedGraph::publish(const char* name, Graph& g, const int64_t* originalIds){
+    g.finalize();
+    std::string segment = segmentName(name);
+    int64_t numVertices = g.numVertices();
+    int64_t numEdges = g.numEdges();
+    size_t bytes = segmentBytes(numVertices, numEdges, originalIds != nullptr);
+
+    // a new segment: the processes attached to an old one keep it until they unmap it
+    shm_unlink(segment.c_str());
+    int fd = shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1) {
+      fprintf(stderr, "Cannot create shared memory segment %s: %s \n", segment.c_str(), strerror(errno));
+      return false;
+    }
+    if (ftruncate(fd, bytes) != 0) {
+      fprintf(stderr, "Cannot size shared memory segment %s: %s \n", segment.c_str(), strerror(errno));
+      close(fd);
+      shm_unlink(segment.c_str());
+      return false;
+    }
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // (the mapping stays valid)
+    if (map == MAP_FAILED) {
+      fprintf(stderr, "Cannot map shared memory segment %s: %s \n", segment.c_str(), strerror(errno));
+      shm_unlink(segment.c_str());
+      return false;
+    }
+    Header* header = static_cast<Header*>(map);
+    header->numVertices = numVertices;
+    header->numEdges = numEdges;
+    header->hasOriginalIds = (originalIds != nullptr) ? 1 : 0;
+    int64_t* next = reinterpret_cast<int64_t*>(header + 1);
+    next = copyAdjacency(g, next, [&g](int64_t v) { return g.getChildren(v); });
+    next = copyAdjacency(g, next, [&g](int64_t v) { return g.getParents(v); });
+    if (originalIds != nullptr) {
+      std::copy(originalIds, originalIds + numVertices, next);
+    }
+    __sync_synchronize(); // (the arrays are complete before the magic is)
+    memcpy(header->magic, GRAPH_MAGIC, sizeof(header->magic));
+    munmap(map, bytes);
+    return true;
+  }
+
+  SharedGraph*
+  SharedGraph::attach(const char* name){
+    std::string segment = segmentName(name);
+    int fd = shm_open(segment.c_str(), O_RDONLY, 0);
+    if (fd == -1) {
+      fprintf(stderr, "Cannot open shared memory segment %s: %s \n", segment.c_str(), strerror(errno));
+      return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(Header)) {
+      fprintf(stderr, "Not a published graph: %s \n", segment.c_str());
+      close(fd);
+      return nullptr;
+    }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // (the mapping stays valid)
+    if (map == MAP_FAILED) {
+      fprintf(stderr, "Cannot map shared memory segment %s: %s \n", segment.c_str(), strerror(errno));
+      return nullptr;
+    }
+    const Header* header = static_cast<const Header*>(map);
+    if (memcmp(header->magic, GRAPH_MAGIC, sizeof(header->magic)) != 0 || header->numVertices < 0 || header->numEdges < 0
+	|| size_t(st.st_size) != segmentBytes(header->numVertices, header->numEdges, header->hasOriginalIds != 0)) {
+      fprintf(stderr, "Not a published graph (or not completely written): %s \n", segment.c_str());
+      munmap(map, st.st_size);
+      return nullptr;
+    }
+    return new SharedGraph(map, st.st_size);
+  }
+
+  SharedGraph::SharedGraph(void* map, size_t mapBytes) : Graph(static_cast<Header*>(map)->numVertices, MEM_GRAPH, false) {
+    _map = map;
+    _mapBytes = mapBytes;
+    const Header* header = static_cast<const Header*>(map);
+    _numEdges = header->numEdges;
+    // (the arrays are only read: the pointers of Graph are not const)
+    int64_t* next = const_cast<int64_t*>(reinterpret_cast<const int64_t*>(header + 1));
+    _adjList.start = next;
+    _adjList.ids = next + _numVertices + 1;
+    next = _adjList.ids + _numEdges;
+    _parentList.start = next;
+    _parentList.ids = next + _numVertices + 1;
+    next = _parentList.ids + _numEdges;
+    _originalIds = (header->hasOriginalIds != 0) ? next : nullptr;
+    for (int64_t v = 0; v < _numVertices; ++v) {
+      _outDegree[v] = _adjList.start[v + 1] - _adjList.start[v];
+      _inDegree[v] = _parentList.start[v + 1] - _parentList.start[v];
+    }
+    updateTrackedMemory();
+  }
+
+  SharedGraph::~SharedGraph() {
+    // the arrays are not to be deleted by Graph
+    _adjList.start = nullptr;
+    _adjList.ids = nullptr;
+    _parentList.start = nullptr;
+    _parentList.ids = nullptr;
+    munmap(_map, _mapBytes);
+  }
+
+} // end namespace
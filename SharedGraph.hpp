@@ -0,0 +1,97 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class SharedGraph.
+ * It is a graph whose adjacency arrays are in a named POSIX shared-memory segment: published once by a process (option --publish-graph), then mapped read-only by the others (option --attach-graph).
+ */
+
+#ifndef SHARED_GRAPH_HPP
+#define SHARED_GRAPH_HPP
+
+#include "globalDefs.hpp"
+#include "Graph.hpp"
+
+namespace supbub{
+
+  /** Class SharedGraph
+   * The segment holds, after a header (magic "SUPBUBGR", number of vertices n, number of edges m, whether original ids follow), the arrays of a finalized graph in compressed sparse row form (64-bit integers, native byte order):
+   *   - the children: n + 1 starts, then m ids.
+   *   - the parents: n + 1 starts, then m ids.
+   *   - the original ids of the vertices (option --sparse-ids), n ids, if any.
+   * A graph attached to the segment points into the mapping, so the processes attached to it share one copy of the graph (the pages are those of the segment); only the degrees are arrays of its own.
+   * The graph is immutable: no edge is to be added to it.
+   *
+   * This class provides for the following:
+   *  - Publishing a (finalized) graph in a segment.
+   *  - Attaching to a segment as a graph.
+   */
+
+  class SharedGraph : public Graph{
+
+  public:
+
+    /** Publishes the given graph in a segment: a segment of the same name is replaced (the processes attached to it keep the old graph).
+     * @param name name of the segment (a leading '/' is added if missing).
+     * @param g reference to the (finalized) graph.
+     * @param originalIds pointer to the original ids of the vertices (n ids), or nullptr.
+     * @return false on an error (written on stderr).
+     */
+    static bool publish(const char* name, Graph& g, const int64_t* originalIds);
+
+    /** Attaches to a published graph.
+     * @param name name of the segment (a leading '/' is added if missing).
+     * @return pointer to a new graph (to be deleted by the caller, which unmaps the segment), or nullptr on an error (written on stderr).
+     */
+    static SharedGraph* attach(const char* name);
+
+    /** Destructor: unmaps the segment. */
+    ~SharedGraph();
+
+    /** Gives the original ids of the vertices if they were published, nullptr otherwise. */
+    const int64_t* originalIds() { return _originalIds; }
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** type for the header of the segment */
+    struct Header{
+      char magic[8];          // "SUPBUBGR" (written last, once the arrays are)
+      int64_t numVertices;    // number of vertices
+      int64_t numEdges;       // number of edges
+      int64_t hasOriginalIds; // 1 if the original ids follow the parents, 0 otherwise
+    };
+
+    /** Constructor
+     * @param map pointer to the mapped segment (checked already).
+     * @param mapBytes size of the segment in bytes.
+     */
+    SharedGraph(void* map, size_t mapBytes);
+
+    /** mapped segment and its size in bytes */
+    void* _map;
+    size_t _mapBytes;
+
+    /** original ids of the vertices (pointer into the mapping), nullptr if none */
+    const int64_t* _originalIds;
+
+    /** Gives the name of a segment with its leading '/'. */
+    static std::string segmentName(const char* name);
+
+    /** Gives the size in bytes of a segment. */
+    static size_t segmentBytes(int64_t numVertices, int64_t numEdges, bool originalIds);
+  };
+
+} // end namespace
+#endif
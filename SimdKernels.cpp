@@ -0,0 +1,263 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements the data-parallel kernels with runtime dispatch.
+ */
+#include "SimdKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SUPBUB_X86
+#include <immintrin.h>
+#endif
+
+namespace supbub{
+
+  /* Below this length, the scalar loop is used directly (not worth the vector setup). */
+  static const int64_t MIN_VECTOR_LEN = 8;
+
+  //////////////////////// scalar ////////////////////////
+
+  template<bool isMin>
+  static inline int64_t better(int64_t a, int64_t b){
+    return isMin ? (b < a ? b : a) : (b > a ? b : a);
+  }
+
+  template<bool isMin>
+  static int64_t
+  gatherScalar(const int64_t* ids, int64_t len, const int64_t* ord, int64_t init){
+    int64_t res = init;
+    if (ord == nullptr) {
+      for (int64_t i = 0; i < len; ++i) {
+	res = better<isMin>(res, ids[i]);
+      }
+    } else {
+      for (int64_t i = 0; i < len; ++i) {
+	res = better<isMin>(res, ord[ids[i]]);
+      }
+    }
+    return res;
+  }
+
+  template<bool isMin>
+  static int64_t
+  reduceScalar(const int64_t* a, int64_t len){
+    return gatherScalar<isMin>(a + 1, len - 1, nullptr, a[0]);
+  }
+
+  template<bool isMin>
+  static void
+  pairwiseScalar(const int64_t* a, const int64_t* b, int64_t* out, int64_t len){
+    for (int64_t i = 0; i < len; ++i) {
+      out[i] = better<isMin>(a[i], b[i]);
+    }
+  }
+
+#ifdef SUPBUB_X86
+  //////////////////////// AVX2 ////////////////////////
+  // AVX2 has no 64-bit min/max: compare and blend.
+
+  template<bool isMin>
+  __attribute__((target("avx2")))
+  static inline __m256i
+  better256(__m256i a, __m256i b){
+    __m256i takeB = isMin ? _mm256_cmpgt_epi64(a, b) : _mm256_cmpgt_epi64(b, a);
+    return _mm256_blendv_epi8(a, b, takeB);
+  }
+
+  template<bool isMin>
+  __attribute__((target("avx2")))
+  static int64_t
+  gatherAvx2(const int64_t* ids, int64_t len, const int64_t* ord, int64_t init){
+    __m256i acc = _mm256_set1_epi64x(init);
+    int64_t i = 0;
+    if (ord == nullptr) {
+      for (; i + 4 <= len; i += 4) {
+	acc = better256<isMin>(acc, _mm256_loadu_si256((const __m256i*)(ids + i)));
+      }
+    } else {
+      for (; i + 4 <= len; i += 4) {
+	__m256i idx = _mm256_loadu_si256((const __m256i*)(ids + i));
+	acc = better256<isMin>(acc, _mm256_i64gather_epi64((const long long*)ord, idx, 8));
+      }
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    int64_t res = reduceScalar<isMin>(lanes, 4);
+    return gatherScalar<isMin>(ids + i, len - i, ord, res);
+  }
+
+  template<bool isMin>
+  __attribute__((target("avx2")))
+  static int64_t
+  reduceAvx2(const int64_t* a, int64_t len){
+    return gatherAvx2<isMin>(a + 1, len - 1, nullptr, a[0]);
+  }
+
+  template<bool isMin>
+  __attribute__((target("avx2")))
+  static void
+  pairwiseAvx2(const int64_t* a, const int64_t* b, int64_t* out, int64_t len){
+    int64_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+      __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+      __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+      _mm256_storeu_si256((__m256i*)(out + i), better256<isMin>(x, y));
+    }
+    pairwiseScalar<isMin>(a + i, b + i, out + i, len - i);
+  }
+
+  //////////////////////// AVX-512 ////////////////////////
+
+  template<bool isMin>
+  __attribute__((target("avx512f")))
+  static inline __m512i
+  better512(__m512i a, __m512i b){
+    return isMin ? _mm512_min_epi64(a, b) : _mm512_max_epi64(a, b);
+  }
+
+  template<bool isMin>
+  __attribute__((target("avx512f")))
+  static int64_t
+  gatherAvx512(const int64_t* ids, int64_t len, const int64_t* ord, int64_t init){
+    __m512i acc = _mm512_set1_epi64(init);
+    int64_t i = 0;
+    if (ord == nullptr) {
+      for (; i + 8 <= len; i += 8) {
+	acc = better512<isMin>(acc, _mm512_loadu_si512((const void*)(ids + i)));
+      }
+    } else {
+      for (; i + 8 <= len; i += 8) {
+	__m512i idx = _mm512_loadu_si512((const void*)(ids + i));
+	acc = better512<isMin>(acc, _mm512_i64gather_epi64(idx, (const void*)ord, 8));
+      }
+    }
+    int64_t res = isMin ? _mm512_reduce_min_epi64(acc) : _mm512_reduce_max_epi64(acc);
+    return gatherScalar<isMin>(ids + i, len - i, ord, res);
+  }
+
+  template<bool isMin>
+  __attribute__((target("avx512f")))
+  static int64_t
+  reduceAvx512(const int64_t* a, int64_t len){
+    return gatherAvx512<isMin>(a + 1, len - 1, nullptr, a[0]);
+  }
+
+  template<bool isMin>
+  __attribute__((target("avx512f")))
+  static void
+  pairwiseAvx512(const int64_t* a, const int64_t* b, int64_t* out, int64_t len){
+    int64_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+      __m512i x = _mm512_loadu_si512((const void*)(a + i));
+      __m512i y = _mm512_loadu_si512((const void*)(b + i));
+      _mm512_storeu_si512((void*)(out + i), better512<isMin>(x, y));
+    }
+    pairwiseScalar<isMin>(a + i, b + i, out + i, len - i);
+  }
+#endif
+
+  //////////////////////// dispatch ////////////////////////
+
+  /** type for the set of kernels of one instruction set */
+  struct KernelTable{
+    SimdLevel level;
+    int64_t (*gatherMin)(const int64_t*, int64_t, const int64_t*, int64_t);
+    int64_t (*gatherMax)(const int64_t*, int64_t, const int64_t*, int64_t);
+    int64_t (*arrayMin)(const int64_t*, int64_t);
+    int64_t (*arrayMax)(const int64_t*, int64_t);
+    void (*pairwiseMin)(const int64_t*, const int64_t*, int64_t*, int64_t);
+    void (*pairwiseMax)(const int64_t*, const int64_t*, int64_t*, int64_t);
+  };
+
+  static KernelTable
+  selectKernels(){
+#ifdef SUPBUB_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return KernelTable{SIMD_AVX512, gatherAvx512<true>, gatherAvx512<false>, reduceAvx512<true>, reduceAvx512<false>, pairwiseAvx512<true>, pairwiseAvx512<false>};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return KernelTable{SIMD_AVX2, gatherAvx2<true>, gatherAvx2<false>, reduceAvx2<true>, reduceAvx2<false>, pairwiseAvx2<true>, pairwiseAvx2<false>};
+    }
+#endif
+    return KernelTable{SIMD_SCALAR, gatherScalar<true>, gatherScalar<false>, reduceScalar<true>, reduceScalar<false>, pairwiseScalar<true>, pairwiseScalar<false>};
+  }
+
+  static const KernelTable&
+  kernels(){
+    static const KernelTable table = selectKernels(); // selected once (thread-safe initialisation)
+    return table;
+  }
+
+  SimdLevel
+  simdLevel(){
+    return kernels().level;
+  }
+
+  const char*
+  simdLevelName(SimdLevel level){
+    switch (level) {
+    case SIMD_AVX512:
+      return "avx512";
+    case SIMD_AVX2:
+      return "avx2";
+    default:
+      return "scalar";
+    }
+  }
+
+  int64_t
+  gatherMin(const int64_t* ids, int64_t len, const int64_t* ord, int64_t init){
+    if (len < MIN_VECTOR_LEN) {
+      return gatherScalar<true>(ids, len, ord, init);
+    }
+    return kernels().gatherMin(ids, len, ord, init);
+  }
+
+  int64_t
+  gatherMax(const int64_t* ids, int64_t len, const int64_t* ord, int64_t init){
+    if (len < MIN_VECTOR_LEN) {
+      return gatherScalar<false>(ids, len, ord, init);
+    }
+    return kernels().gatherMax(ids, len, ord, init);
+  }
+
+  int64_t
+  arrayMin(const int64_t* a, int64_t len){
+    if (len < MIN_VECTOR_LEN) {
+      return reduceScalar<true>(a, len);
+    }
+    return kernels().arrayMin(a, len);
+  }
+
+  int64_t
+  arrayMax(const int64_t* a, int64_t len){
+    if (len < MIN_VECTOR_LEN) {
+      return reduceScalar<false>(a, len);
+    }
+    return kernels().arrayMax(a, len);
+  }
+
+  void
+  pairwiseMin(const int64_t* a, const int64_t* b, int64_t* out, int64_t len){
+    kernels().pairwiseMin(a, b, out, len);
+  }
+
+  void
+  pairwiseMax(const int64_t* a, const int64_t* b, int64_t* out, int64_t len){
+    kernels().pairwiseMax(a, b, out, len);
+  }
+
+} // end namespace
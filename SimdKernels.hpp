@@ -0,0 +1,60 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Declares the data-parallel kernels used while preparing a DAG for detection.
+ * Each kernel has a scalar, an AVX2 and an AVX-512 version. The version is selected once at runtime
+ * depending on the instruction sets supported by the cpu, so the binary can be built without -mavx2.
+ */
+
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include "globalDefs.hpp"
+
+namespace supbub{
+
+  /** instruction set used by the kernels */
+  enum SimdLevel { SIMD_SCALAR, SIMD_AVX2, SIMD_AVX512 };
+
+  /** Returns the instruction set selected for the kernels (the widest one supported by the cpu). */
+  SimdLevel simdLevel();
+
+  /** Returns the name of the given instruction set. */
+  const char* simdLevelName(SimdLevel level);
+
+  /** Returns the minimum of init and ord[ids[i]] for 0 <= i < len.
+   * If ord is nullptr, it is taken as the identity (minimum of init and ids[i]).
+   */
+  int64_t gatherMin(const int64_t* ids, int64_t len, const int64_t* ord, int64_t init);
+
+  /** Returns the maximum of init and ord[ids[i]] for 0 <= i < len.
+   * If ord is nullptr, it is taken as the identity (maximum of init and ids[i]).
+   */
+  int64_t gatherMax(const int64_t* ids, int64_t len, const int64_t* ord, int64_t init);
+
+  /** Returns the minimum of a[0] ... a[len-1]. Assumes len >= 1. */
+  int64_t arrayMin(const int64_t* a, int64_t len);
+
+  /** Returns the maximum of a[0] ... a[len-1]. Assumes len >= 1. */
+  int64_t arrayMax(const int64_t* a, int64_t len);
+
+  /** Fills out[i] = min(a[i], b[i]) for 0 <= i < len. */
+  void pairwiseMin(const int64_t* a, const int64_t* b, int64_t* out, int64_t len);
+
+  /** Fills out[i] = max(a[i], b[i]) for 0 <= i < len. */
+  void pairwiseMax(const int64_t* a, const int64_t* b, int64_t* out, int64_t len);
+
+} // end namespace
+#endif
@@ -36,6 +36,7 @@ namespace supbub{
    *
    * This class also provides for obtaining the underlying Directed Acyclic Graph(DAG), G', using the algorithm described in the paper "An O(m log m) -time Algorithm For Detecting Superbubbles" by Sung et al. This class is reponsible for creating and destroying its DAG.
    *  - For obtaining a DAG from a subgraph, method requires to create two vertices(u' and u'') for each vertex(u) in the subgraph except for source(r) and terminal/sink(r'). A source and a terminal are also added to this DAG. Then edges are added to DAG depending on some conditions (see the paper).
+   *    -- The edges of the DAG are not stored: they are derived from those of the subgraph and its DFS index (see DAG).
    *    -- Let offset is equal to the number of vertices(except r and r') in the subgraph.
    *       --- Thus, in a DAG of the subgpah, number of vertices = 2 * offset + 2
    *       --- This class approaches this 'duplication' of vertices by considering u and u' have same local-ids in the subgraph and its DAG while u'' has an id(called duplicate-local-id)) equal to (id of u + offset). To summarise,
@@ -49,7 +50,8 @@ namespace supbub{
    *    -- Does a given id of G' correspond to a duplicate u'' of some u'.
    *    -- Id of u' for some dplicate vertex u'' in G'.
    *    -- Offset of this subgraph. (as id of every u' is in the range[0, offset))
-   *  - It also maintains the dicovery and finishing times of the vertices in its DFS traversal to answer queries of the form: Is vertex x an ancesstor of vertex y?
+   *  - It also maintains an index of the DFS tree of its traversal (the preorder number of each vertex and the largest preorder number in its subtree, 32 bits each) to answer queries of the form: Is vertex x an ancesstor of vertex y?
+   *    The index is released by releaseAncestorIndex() once the 'unreal' superbubbles are filtered out.
    *
    * To conclude, this class provides for the following:
    *  - Setting global-id of a vertex.
@@ -79,15 +81,31 @@ namespace supbub{
     /** Returns the global-id for a given local-id.
      * @param v local vertex-id.
      * @return global vertex-id of v.
-     *         or -1 if v is invalid
+     *         or -1 if v is invalid (checked build only)
      */
-    int64_t getGlobalId(int64_t v);
+    int64_t getGlobalId(int64_t v) {
+#if SUPBUB_CHECKED
+      if (v >= _numVertices || v < 0) {
+	invalidId("Invalid v : ", v);
+	return -1;
+      }
+#endif
+      return _reverseMapId[v];
+    }
 
      /** Sets the global vertex-id of the given local vertex-id.
      * @param localId local-id of the vertex whose global-id is to be set.
      * @param globalId global-id to be set.
      */
-    void setGlobalId(int64_t localId, int64_t globalId);
+    void setGlobalId(int64_t localId, int64_t globalId) {
+#if SUPBUB_CHECKED
+      if (localId >= _numVertices || localId < 0) {
+	invalidId("Invalid localId : ", localId);
+	return;
+      }
+#endif
+      _reverseMapId[localId] = globalId;
+    }
 
      /** Returns the local-id of the source(r) of the graph.
      *
@@ -95,56 +113,83 @@ namespace supbub{
      *
      */
 
-    int64_t getSourceId();
+    int64_t getSourceId() { return _numVertices-2; }
 
      /** Returns the local-id of the terminal/sink(r') of the graph.
      *
      * It is the last vertex.
      *
      */
-    int64_t getTerminalId();
+    int64_t getTerminalId() { return _numVertices-1; }
 
     /** Returns the duplicate-local-id of the vertex with the given local-id. 
-     * @return duplicate-local-id of v or -1 if v is invalid
+     * @return duplicate-local-id of v or -1 if v is invalid (checked build only)
      */
-    int64_t getDuplicateId(int64_t v);
+    int64_t getDuplicateId(int64_t v) {
+#if SUPBUB_CHECKED
+      if (v >= _numVertices || v < 0) {
+	invalidId("Invalid v : ", v);
+	return -1;
+      }
+#endif
+      return v + _offSet;
+    }
 
     /** Returns the original-local-id of the vertex with the given duplicate-local-id. 
-     * @return original-local-id of v or -1 if v is invalid
+     * @return original-local-id of v or -1 if v is invalid (checked build only)
      */
-    int64_t getOriginalId(int64_t v);
+    int64_t getOriginalId(int64_t v) {
+#if SUPBUB_CHECKED
+      if (v >= 2*_offSet || v < _offSet) {
+	invalidId("Invalid v'' : ", v);
+	return -1;
+      }
+#endif
+      return v - _offSet;
+    }
 
     /** Checks whether the given local-id corresponds to duplicate(u'') vertex in the resultant dag or not. 
      * @param v given local-id.
      * @return true if v is local-id corresponding to duplicate vertex(u'') in the resultant dag G'.
      *         false if v is local-id corresponding to original vertex(u') in the resultant dag G'.
-     *         an invalid v also returns false. 
+     *         an invalid v also returns false (checked build only). 
      */
-    bool isDuplicateId(int64_t v);
+    bool isDuplicateId(int64_t v) {
+#if SUPBUB_CHECKED
+      if (v >= 2*_offSet + 2 || v < 0) { // any id of the DAG
+	invalidId("Invalid v : ", v);
+	return false;
+      }
+#endif
+      return (v >= _offSet && v < 2*_offSet);
+    }
 
-    /** Checks whether the given vertex is an ancestor of the given other vertex in DFS tree of this subgraph.
+    /** Checks whether the given vertex is a (proper) ancestor of the given other vertex in DFS tree of this subgraph.
      *
-     * getDag() should have been called before making a call to this function.
+     * getDag() should have been called before making a call to this function (and releaseAncestorIndex() not yet).
+     * Assumes anc and des are valid local-ids. No branch: the preorder number of des minus the one of anc minus one, as an unsigned, is below the number of proper descendants of anc.
      * 
      * @param anc given local-id of ancestor.
      * @param des given local-id of descendant.
-     * @return true if anc is an ancestor of des (i.e. discovery and finishing time of des lies in the range corresponding to discovery and finishing times of anc).
-     *         false if above condition isn't satisfied 
-     *               or anc/des/both are invalid
-     *               or getDAG() hasn't been called earlier than this function.
-     * 
+     * @return true if anc is an ancestor of des (i.e. preorder number of des lies in (preorder number of anc, largest preorder number in the subtree of anc]).
+     *         false otherwise.
      */
-    bool isAncestor(int64_t anc, int64_t des);
+    bool isAncestor(int64_t anc, int64_t des) { return uint32_t(_preorder[des] - _preorder[anc] - 1) < uint32_t(_lastInSubtree[anc] - _preorder[anc]); }
+
+    /** Releases the index used by isAncestor() (once the 'unreal' superbubbles are filtered out). */
+    void releaseAncestorIndex();
 
     /** Returns offset of this subgraph.
      */
-    int64_t getOffset();
+    int64_t getOffset() { return _offSet; }
 
     /** Returns a pointer to the underlying DAG of this subgraph. 
      * Follows GraphToDAG method described in the paper.
      * Uses DFS to find back-edges required in the method.
-     * At the same time fills the discovery and finishing time arrays of the vertices, required later while answering 'ancesstor queries'.
+     * The DFS fills the index of the DFS tree (preorder numbers), which tells the back edges and later answers 'ancesstor queries'.
+     * The DFS is iterative (its depth may be as large as the number of vertices).
      * The random source-vertex selected(if any)[as required in the method] is that with the local-id 0. 
+     * The edges of the DAG are not stored: it derives them from the adjacency of this subgraph and the index (a doubled DAG, see DAG), so it must not be used after releaseAncestorIndex().
      */
     DAG* getDAG();
 
@@ -165,22 +210,19 @@ namespace supbub{
 
     DAG* _dag;
 
-    /** Pointer to the array mapping subgraph's(G) vertices to their discovery time in DFS traversal. */
-    int64_t* _discovery;
-
-    /** Pointer to the array mapping subgraph's(G) vertices to their finishing time in DFS traversal. */
-    int64_t* _finish;
+    /** Pointer to the array mapping subgraph's(G) vertices to their preorder number (from 1) in DFS traversal (0 if not visited yet). */
+    uint32_t* _preorder;
 
-    /** enum for vertex-color used in case of DFS to identify back-edges*/
-    enum Color { WHITE, GRAY, BLACK };
+    /** Pointer to the array mapping subgraph's(G) vertices to the largest preorder number in their DFS subtree (0 until they are finished). */
+    uint32_t* _lastInSubtree;
 
-    /** Adds edges to the underlying DAG along with filling discovery and finishing time of the vertices in DFS traversal. 
-     * @param u root vertex.
-     * @param tick clock for dicvery and finishing time.
-     * @param color Pointer to an array marking colors of the vertices to keep track of unvisited(WHITE), visited but not finished(GRAY) and finished(BLACK) vertices.
+    /** Fills the preorder numbers of the vertices in DFS traversal (and the largest preorder number in the subtree of each vertex). 
+     * Iterative: the vertices being visited are kept on an explicit stack along with their next child.
+     * A vertex is unvisited(WHITE) if it has no preorder number, visited but not finished(GRAY) if it has no largest preorder number in its subtree yet, and finished(BLACK) otherwise.
+     * @param root root vertex.
      *
      */   
-    void DFSVisit(int64_t u, int64_t& tick, Color* color);
+    void DFSVisit(int64_t root);
   
 
  
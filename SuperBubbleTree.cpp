@@ -0,0 +1,119 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements the output of the tree of superbubbles.
+ */
+#include "SuperBubbleTree.hpp"
+#include "MemoryStats.hpp"
+
+#include <sstream>
+
+namespace supbub{
+
+  /* Fills in the position of the parent of each superbubble (-1 if none).
+   * Each vertex is the entrance of at most one superbubble, so the parent is found from its entrance.
+   */
+  static void
+  fillParentPositions(const DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList, int64_t numVertices, int64_t* parentPosition){
+    int64_t* positionOfEntrance = new int64_t[numVertices];
+    memoryChanged(MEM_RESULTS, sizeof(int64_t) * numVertices);
+    int64_t k = 0;
+    for (auto i = superBubblesList.begin(); i != superBubblesList.end(); ++i, ++k) {
+      positionOfEntrance[(*i).entrance] = k;
+    }
+    k = 0;
+    for (auto i = superBubblesList.begin(); i != superBubblesList.end(); ++i, ++k) {
+      parentPosition[k] = ((*i).parent == -1) ? -1 : positionOfEntrance[(*i).parent];
+    }
+    delete[] positionOfEntrance;
+    memoryChanged(MEM_RESULTS, -int64_t(sizeof(int64_t)) * numVertices);
+  }
+
+  void
+  writeParentArray(std::ostream& out, const DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList, int64_t numVertices){
+    int64_t k = superBubblesList.size();
+    int64_t* parentPosition = new int64_t[k];
+    memoryChanged(MEM_RESULTS, sizeof(int64_t) * k);
+    fillParentPositions(superBubblesList, numVertices, parentPosition);
+    for (int64_t i = 0; i < k; ++i) {
+      out << parentPosition[i] << "\n";
+    }
+    delete[] parentPosition;
+    memoryChanged(MEM_RESULTS, -int64_t(sizeof(int64_t)) * k);
+  }
+
+  void
+  writeBalancedParentheses(std::ostream& out, const DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList, int64_t numVertices){
+    int64_t k = superBubblesList.size();
+    // parentPosition, children grouped by parent (roots as children of k), position of the first child of each, stack of the walk
+    int64_t* parentPosition = new int64_t[k];
+    int64_t* children = new int64_t[k];
+    int64_t* firstChild = new int64_t[k + 2];
+    int64_t* stack = new int64_t[k + 1];
+    memoryChanged(MEM_RESULTS, sizeof(int64_t) * (4 * k + 3));
+    fillParentPositions(superBubblesList, numVertices, parentPosition);
+
+    std::fill_n(firstChild, k + 2, 0);
+    for (int64_t i = 0; i < k; ++i) {
+      int64_t p = (parentPosition[i] == -1) ? k : parentPosition[i];
+      firstChild[p + 1]++;
+    }
+    for (int64_t p = 0; p <= k; ++p) {
+      firstChild[p + 1] += firstChild[p];
+    }
+    for (int64_t i = 0; i < k; ++i) { // (firstChild[p] is moved to the end of the children of p)
+      int64_t p = (parentPosition[i] == -1) ? k : parentPosition[i];
+      children[firstChild[p]++] = i;
+    }
+    for (int64_t p = k; p > 0; --p) { // restore
+      firstChild[p] = firstChild[p - 1];
+    }
+    firstChild[0] = 0;
+
+    // Walk the tree from the virtual root k without recursion (nesting can be deep):
+    // parentPosition is reused to keep the next child to visit of each superbubble on the stack.
+    std::string parentheses;
+    parentheses.reserve(2 * k);
+    std::ostringstream preorder;
+    int64_t nextOfRoot = firstChild[k];
+    int64_t top = 0;
+    stack[0] = k;
+    while (top >= 0) {
+      int64_t p = stack[top];
+      int64_t& next = (p == k) ? nextOfRoot : parentPosition[p];
+      if (next < firstChild[p + 1]) { // enter next child
+	int64_t c = children[next++];
+	parentheses.push_back('(');
+	preorder << ((parentheses.size() > 1) ? " " : "") << c;
+	parentPosition[c] = firstChild[c];
+	stack[++top] = c;
+      }
+      else { // leave p
+	if (p != k) {
+	  parentheses.push_back(')');
+	}
+	--top;
+      }
+    }
+    out << parentheses << "\n" << preorder.str() << "\n";
+
+    delete[] parentPosition;
+    delete[] children;
+    delete[] firstChild;
+    delete[] stack;
+    memoryChanged(MEM_RESULTS, -int64_t(sizeof(int64_t)) * (4 * k + 3));
+  }
+
+} // end namespace
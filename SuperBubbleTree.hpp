@@ -0,0 +1,46 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Declares the output of the tree of superbubbles (superbubble tree).
+ * A superbubble is a child of the smallest superbubble containing it (found during detection, see option hierarchy of DetectSuperBubble).
+ * Superbubbles are referred to by their position in the list of results (which is the order of the output file).
+ */
+
+#ifndef SUPERBUBBLE_TREE_HPP
+#define SUPERBUBBLE_TREE_HPP
+
+#include "globalDefs.hpp"
+#include "DetectSuperBubble.hpp"
+
+namespace supbub{
+
+  /** Writes the tree as a parent array: one line per superbubble (in the order of the list) holding the position of its parent, -1 if none.
+   * @param out reference to the stream to be written.
+   * @param superBubblesList reference to the list of superbubbles (found with option hierarchy).
+   * @param numVertices number of vertices of the graph.
+   */
+  void writeParentArray(std::ostream& out, const DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList, int64_t numVertices);
+
+  /** Writes the tree (a forest) as balanced parentheses: a superbubble is an opening parenthesis followed by its children and a closing parenthesis.
+   * The first line holds the parentheses and the second line the positions of the superbubbles in the order of their opening parentheses (preorder).
+   * Children are in the order of the list.
+   * @param out reference to the stream to be written.
+   * @param superBubblesList reference to the list of superbubbles (found with option hierarchy).
+   * @param numVertices number of vertices of the graph.
+   */
+  void writeBalancedParentheses(std::ostream& out, const DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList, int64_t numVertices);
+
+} // end namespace
+#endif
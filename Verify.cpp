@@ -0,0 +1,203 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements the verification of the superbubbles found.
+ */
+#include "Verify.hpp"
+#include "EpochArray.hpp"
+#include "MemoryStats.hpp"
+
+namespace supbub{
+
+  /* states of the vertices during the search from an entrance (EpochArray default: not reached) */
+  static const int64_t STATE_SEEN = 0;
+  static const int64_t STATE_VISITED = 1;
+
+  /* number of differences printed for each reference */
+  static const int64_t MAX_PRINTED_DIFFERENCES = 10;
+
+  /* Searches the superbubble with entrance s.
+   * Returns its exit (and fills in its numbers of vertices and edges), -1 if none.
+   * parentsLeft counts the edges into a reached vertex from vertices not visited yet (so parallel edges count as one parent).
+   */
+  static int64_t
+  searchExit(Graph& g, int64_t s, EpochArray& state, EpochArray& parentsLeft, std::vector<int64_t>& toVisit, int64_t& numVertices, int64_t& numEdges){
+    state.reset(g.numVertices());
+    parentsLeft.reset(g.numVertices());
+    toVisit.clear();
+    toVisit.push_back(s);
+    state.set(s, STATE_SEEN);
+    int64_t numSeen = 1; // seen but not visited
+    numVertices = 0;
+    numEdges = 0;
+    while (!toVisit.empty()) {
+      int64_t v = toVisit.back();
+      toVisit.pop_back();
+      if (state.get(v) == STATE_SEEN) {
+	numSeen--;
+      }
+      state.set(v, STATE_VISITED);
+      numVertices++;
+      numEdges += g.getOutDegree(v);
+      int64_t_LIST children = g.getChildren(v);
+      if (children.empty()) { // tip
+	return -1;
+      }
+      for (int64_t_LIST_ITERATOR i = children.begin(); i != children.end(); ++i) {
+	int64_t u = *i;
+	if (u == s) { // cycle through s
+	  return -1;
+	}
+	if (state.get(u) != STATE_SEEN) { // (a visited vertex seen again is on a cycle: it is never visited again)
+	  state.set(u, STATE_SEEN);
+	  numSeen++;
+	}
+	int64_t left = parentsLeft.get(u);
+	left = ((left == -1) ? g.getInDegree(u) : left) - 1;
+	parentsLeft.set(u, left);
+	if (left == 0) {
+	  toVisit.push_back(u);
+	}
+      }
+      if (toVisit.size() == 1 && numSeen == 1) {
+	int64_t t = toVisit.back();
+	int64_t_LIST tChildren = g.getChildren(t);
+	for (int64_t_LIST_ITERATOR i = tChildren.begin(); i != tChildren.end(); ++i) {
+	  if (*i == s) { // edge t-s
+	    return -1;
+	  }
+	}
+	numVertices++; // t
+	return t;
+      }
+    }
+    return -1;
+  }
+
+  template<class IS_CANDIDATE>
+  void
+  bruteForceSuperBubbles(Graph& g, IS_CANDIDATE isCandidate, DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList){
+    EpochArray state(-1, MEM_RESULTS);
+    EpochArray parentsLeft(-1, MEM_RESULTS);
+    std::vector<int64_t> toVisit;
+    int64_t numVertices, numEdges;
+    for (int64_t s = 0; s < g.numVertices(); ++s) {
+      if (!isCandidate(s)) {
+	continue;
+      }
+      int64_t t = searchExit(g, s, state, parentsLeft, toVisit, numVertices, numEdges);
+      if (t != -1) {
+	superBubblesList.push_back(DetectSuperBubble::SuperBubble{s, t, numVertices, numEdges, -1});
+      }
+    }
+  }
+
+  void
+  prepareVerification(Graph& g, VerifyReference& reference){
+    g.finalize();
+    int64_t* scc = new int64_t[g.numVertices()];
+    g.fillSCC(scc);
+    reference.onCycle.assign(g.numVertices(), false);
+    for (int64_t v = 0; v < g.numVertices(); ++v) {
+      reference.onCycle[v] = (scc[v] != 0);
+    }
+    delete[] scc;
+
+    std::vector<bool>& onCycle = reference.onCycle;
+    bruteForceSuperBubbles(g, [&onCycle](int64_t s) { return !onCycle[s]; }, reference.definition);
+    reference.definition.remove_if([&onCycle](const DetectSuperBubble::SuperBubble& x) { return onCycle[x.exit]; });
+
+    DetectSuperBubble::Options options;
+    options.relabel = false;
+    options.blockRmq = false;
+    options.interiorSizes = true;
+    options.interiorVertices = nullptr;
+    options.originalIds = nullptr;
+    options.vertexNames = nullptr;
+    options.hierarchy = false;
+    options.numThreads = 1;
+    options.unordered = false;
+    DetectSuperBubble dsb(options);
+    dsb.find(g, reference.baseline);
+  }
+
+  /* Compares two lists of superbubbles (in any order) and prints the first differences.
+   * Returns the number of differences.
+   */
+  static int64_t
+  compareSuperBubbles(FILE* out, const char* name, const DetectSuperBubble::SUPERBUBBLE_LIST& expected, const DetectSuperBubble::SUPERBUBBLE_LIST& found, bool sizes, const int64_t* originalIds, const VertexNames* vertexNames){
+    std::vector<DetectSuperBubble::SuperBubble> a(expected.begin(), expected.end());
+    std::vector<DetectSuperBubble::SuperBubble> b(found.begin(), found.end());
+    auto byEntrance = [](const DetectSuperBubble::SuperBubble& x, const DetectSuperBubble::SuperBubble& y) {
+      return (x.entrance < y.entrance || (x.entrance == y.entrance && x.exit < y.exit));
+    };
+    std::sort(a.begin(), a.end(), byEntrance);
+    std::sort(b.begin(), b.end(), byEntrance);
+
+    int64_t differences = 0;
+    auto print = [&](const char* what, const DetectSuperBubble::SuperBubble& x) {
+      if (differences <= MAX_PRINTED_DIFFERENCES) {
+	if (vertexNames != nullptr) {
+	  fprintf(out, "%s: %s superbubble <%.*s,%.*s>", name, what, int(vertexNames->nameLength(x.entrance)), vertexNames->name(x.entrance), int(vertexNames->nameLength(x.exit)), vertexNames->name(x.exit));
+	}
+	else {
+	  int64_t entranceId = (originalIds == nullptr) ? x.entrance : originalIds[x.entrance];
+	  int64_t exitId = (originalIds == nullptr) ? x.exit : originalIds[x.exit];
+	  fprintf(out, "%s: %s superbubble <%ld,%ld>", name, what, (long)entranceId, (long)exitId);
+	}
+	if (sizes) {
+	  fprintf(out, " %ld %ld", (long)x.numVertices, (long)x.numEdges);
+	}
+	fprintf(out, "\n");
+      }
+    };
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+      if (j == b.size() || (i < a.size() && byEntrance(a[i], b[j]))) {
+	differences++;
+	print("missing", a[i++]);
+      }
+      else if (i == a.size() || byEntrance(b[j], a[i])) {
+	differences++;
+	print("unexpected", b[j++]);
+      }
+      else {
+	if (sizes && (a[i].numVertices != b[j].numVertices || a[i].numEdges != b[j].numEdges)) {
+	  differences++;
+	  print("expected", a[i]);
+	  print("but found", b[j]);
+	}
+	i++;
+	j++;
+      }
+    }
+    fprintf(out, "%s: %ld superbubbles expected, %ld differences \n", name, (long)a.size(), (long)differences);
+    return differences;
+  }
+
+  int64_t
+  verifySuperBubbles(FILE* out, VerifyReference& reference, const DetectSuperBubble::SUPERBUBBLE_LIST& found, bool sizes, const int64_t* originalIds, const VertexNames* vertexNames){
+    DetectSuperBubble::SUPERBUBBLE_LIST acyclicFound;
+    for (auto i = found.begin(); i != found.end(); ++i) {
+      if (!reference.onCycle[(*i).entrance] && !reference.onCycle[(*i).exit]) {
+	acyclicFound.push_back(*i);
+      }
+    }
+    int64_t differences = compareSuperBubbles(out, "Verify (definition, vertices on no cycle)", reference.definition, acyclicFound, sizes, originalIds, vertexNames);
+    differences += compareSuperBubbles(out, "Verify (default options)", reference.baseline, found, sizes, originalIds, vertexNames);
+    return differences;
+  }
+
+} // end namespace
@@ -0,0 +1,65 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Declares the verification of the superbubbles found in a graph (option --verify), for small graphs.
+ * Two references are computed while the graph is in memory, before detection:
+ *  - the superbubbles found from their definition, one possible entrance at a time (O(n m) in all). The partition into sccs (paper-1) gives other results than the definition around cycles, so only the superbubbles whose entrance and exit are on no cycle are compared with it.
+ *  - the superbubbles found by DetectSuperBubble::find() with the default options (one thread, no relabelling, succinct rmq, in memory), compared with all of the results: the other paths (threads, relabelling, BlockRMQ, out-of-core) have to give the same.
+ */
+
+#ifndef VERIFY_HPP
+#define VERIFY_HPP
+
+#include "globalDefs.hpp"
+#include "Graph.hpp"
+#include "DetectSuperBubble.hpp"
+
+namespace supbub{
+
+  /** struct for the references of a graph */
+  struct VerifyReference{
+    DetectSuperBubble::SUPERBUBBLE_LIST definition; // superbubbles by definition with entrance and exit on no cycle
+    DetectSuperBubble::SUPERBUBBLE_LIST baseline;   // superbubbles found with the default options
+    std::vector<bool> onCycle;                      // onCycle[v] is true if v belongs to a non-singleton scc
+  };
+
+  /** Finds the superbubbles of a graph from their definition.
+   * For each vertex s, the vertices reachable from s are visited in topological order (a vertex is visited once all its parents are) until a single vertex t is left to visit and nothing else has been seen: <s, t> is then a superbubble, unless a tip, a cycle through s or an edge t-s is met first (algorithm of Onodera et al., "Detecting superbubbles in assembly graphs"). Parallel edges count as one.
+   * @param g reference to the (finalized) graph.
+   * @param isCandidate function telling whether a vertex is to be tried as entrance.
+   * @param superBubblesList reference to the list to be filled in, sorted by entrance (numVertices and numEdges filled in, parent -1).
+   */
+  template<class IS_CANDIDATE>
+  void bruteForceSuperBubbles(Graph& g, IS_CANDIDATE isCandidate, DetectSuperBubble::SUPERBUBBLE_LIST& superBubblesList);
+
+  /** Computes the references of a graph.
+   * @param g reference to the (finalized) graph.
+   * @param reference reference to the references to be filled in.
+   */
+  void prepareVerification(Graph& g, VerifyReference& reference);
+
+  /** Compares the superbubbles found with the references, and prints the first differences and a summary.
+   * @param out file on which the differences are printed.
+   * @param reference reference to the references of the graph.
+   * @param found reference to the list of superbubbles found (in any order).
+   * @param sizes true if the numbers of vertices and edges are to be compared too.
+   * @param originalIds if not null, the ids printed are translated (originalIds[v] for vertex v of the graph).
+   * @param vertexNames if not null, the names of the vertices are printed instead of their ids.
+   * @return the number of differences (missing, unexpected or with other sizes).
+   */
+  int64_t verifySuperBubbles(FILE* out, VerifyReference& reference, const DetectSuperBubble::SUPERBUBBLE_LIST& found, bool sizes, const int64_t* originalIds, const VertexNames* vertexNames);
+
+} // end namespace
+#endif
@@ -0,0 +1,131 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class VertexIds
+ */
+#include "VertexIds.hpp"
+
+#include <omp.h>
+
+namespace supbub{
+
+  /* log2 of the initial number of slots of the hash table */
+  static const int INITIAL_BITS = 10;
+
+  VertexIds::VertexIds() {
+    _bits = INITIAL_BITS;
+    _slots = new int64_t[int64_t(2) << _bits];
+    std::fill_n(_slots, int64_t(2) << _bits, -1);
+    _trackedBytes = 0;
+    updateTrackedMemory();
+  }
+
+  VertexIds::~VertexIds() {
+    delete[] _slots;
+    memoryChanged(MEM_GRAPH, -_trackedBytes);
+  }
+
+  int64_t
+  VertexIds::intern(int64_t id){
+    int64_t mask = (int64_t(1) << _bits) - 1;
+    int64_t i = home(id);
+    while (_slots[2 * i] != -1) {
+      if (_slots[2 * i] == id) {
+	return _slots[2 * i + 1];
+      }
+      i = (i + 1) & mask;
+    }
+    // new id: the table is kept at most half full
+    int64_t provisional = _originals.size();
+    _slots[2 * i] = id;
+    _slots[2 * i + 1] = provisional;
+    bool grows = (_originals.size() == _originals.capacity());
+    _originals.push_back(id);
+    if (2 * _originals.size() > (size_t(1) << _bits)) {
+      grow();
+    }
+    else if (grows) {
+      updateTrackedMemory();
+    }
+    return provisional;
+  }
+
+  void
+  VertexIds::compact(std::vector<int64_t>& tails, std::vector<int64_t>& heads, int numThreads){
+    int64_t n = _originals.size();
+    std::vector<int64_t> sorted(_originals);
+    std::sort(sorted.begin(), sorted.end());
+    // dense id of each provisional id: the rank of its original id (found back from the table)
+    int64_t* dense = new int64_t[n];
+    memoryChanged(MEM_GRAPH, 2 * sizeof(int64_t) * n);
+    int64_t mask = (int64_t(1) << _bits) - 1;
+    for (int64_t k = 0; k < n; ++k) {
+      int64_t i = home(sorted[k]);
+      while (_slots[2 * i] != sorted[k]) {
+	i = (i + 1) & mask;
+      }
+      dense[_slots[2 * i + 1]] = k;
+    }
+    delete[] _slots;
+    _slots = nullptr;
+    _bits = 0;
+    _originals.swap(sorted);
+    std::vector<int64_t>().swap(sorted);
+    int64_t m = tails.size();
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int64_t e = 0; e < m; ++e) {
+      tails[e] = dense[tails[e]];
+      heads[e] = dense[heads[e]];
+    }
+    delete[] dense;
+    memoryChanged(MEM_GRAPH, -2 * int64_t(sizeof(int64_t)) * n);
+    updateTrackedMemory();
+  }
+
+  //////////////////////// private ////////////////////////
+
+  void
+  VertexIds::grow(){
+    int64_t* old = _slots;
+    int64_t oldSlots = int64_t(1) << _bits;
+    _bits++;
+    _slots = new int64_t[int64_t(2) << _bits];
+    std::fill_n(_slots, int64_t(2) << _bits, -1);
+    int64_t mask = (int64_t(1) << _bits) - 1;
+    for (int64_t j = 0; j < oldSlots; ++j) {
+      if (old[2 * j] != -1) {
+	int64_t i = home(old[2 * j]);
+	while (_slots[2 * i] != -1) {
+	  i = (i + 1) & mask;
+	}
+	_slots[2 * i] = old[2 * j];
+	_slots[2 * i + 1] = old[2 * j + 1];
+      }
+    }
+    delete[] old;
+    updateTrackedMemory();
+  }
+
+  void
+  VertexIds::updateTrackedMemory(){
+    int64_t bytes = sizeof(int64_t) * _originals.capacity();
+    if (_slots != nullptr) {
+      bytes += sizeof(int64_t) * (int64_t(2) << _bits);
+    }
+    memoryChanged(MEM_GRAPH, bytes - _trackedBytes);
+    _trackedBytes = bytes;
+  }
+
+} // end namespace
@@ -0,0 +1,101 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class VertexIds.
+ * It compacts the ids of an input whose vertex ids are sparse (any non-negative 64-bit integers, with gaps) into the dense range 0..n-1 used by the graph, and translates them back.
+ */
+
+#ifndef VERTEX_IDS_HPP
+#define VERTEX_IDS_HPP
+
+#include "globalDefs.hpp"
+#include "MemoryStats.hpp"
+
+namespace supbub{
+
+  /** Class VertexIds
+   * While the input is read, each id is looked up in an open-addressing hash table (linear probing, at most half full) and given a provisional id: the number of distinct ids seen before it.
+   * Once all ids are known, compact() sorts the distinct ids and renumbers them in increasing order, so that the dense ids are in the same order as the original ones
+   * (the superbubbles, sorted by dense entrance, are then also sorted by original entrance).
+   * The table is released then; only the original id of each dense id is kept (8 bytes per vertex).
+   *
+   * This class provides for the following:
+   *  - Giving the provisional id of an original id (while reading).
+   *  - Renumbering the provisional ids of the edges read into dense ids.
+   *  - Giving the original id of a dense id.
+   */
+
+  class VertexIds{
+
+  public:
+
+    /** Constructor (no id yet) */
+    VertexIds();
+
+    /** Destructor */
+    ~VertexIds();
+
+    /** Gives the provisional id of the given original id, which is new if the id has not been seen before.
+     * Must not be called after compact().
+     * @param id original id (non-negative).
+     */
+    int64_t intern(int64_t id);
+
+    /** Gives the number of distinct ids. */
+    int64_t size() { return _originals.size(); }
+
+    /** Renumbers the ids in increasing order of the original ids and replaces the provisional ids in the given arrays by the dense ones.
+     * Releases the hash table: intern() may not be called any more.
+     * @param tails reference to the tails of the edges read (provisional ids).
+     * @param heads reference to the heads of the edges read (provisional ids).
+     * @param numThreads number of threads rewriting the edges.
+     */
+    void compact(std::vector<int64_t>& tails, std::vector<int64_t>& heads, int numThreads);
+
+    /** Returns the original id of the given dense id. Assumes compact() has been called and 0 <= v < size(). */
+    int64_t original(int64_t v) { return _originals[v]; }
+
+    /** Returns the array of the original ids, indexed by dense id (valid until the object is destroyed). Assumes compact() has been called. */
+    const int64_t* originals() { return _originals.data(); }
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** hash table: slot i holds an original id in _slots[2i] (-1 if empty) and its provisional id in _slots[2i+1] */
+    int64_t* _slots;
+
+    /** log2 of the number of slots */
+    int _bits;
+
+    /** original ids, indexed by provisional id (by dense id after compact()) */
+    std::vector<int64_t> _originals;
+
+    /** bytes accounted to MEM_GRAPH */
+    int64_t _trackedBytes;
+
+    /** Returns the first slot to look at for the given id (the high bits of a multiplicative hash). */
+    inline int64_t home(int64_t id){
+      return int64_t((uint64_t(id) * 0x9E3779B97F4A7C15ULL) >> (64 - _bits));
+    }
+
+    /** Doubles the number of slots and inserts the ids again. */
+    void grow();
+
+    /** Accounts the memory currently held. */
+    void updateTrackedMemory();
+  };
+
+} // end namespace
+#endif
@@ -0,0 +1,128 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Implements class VertexNames
+ */
+#include "VertexNames.hpp"
+
+#include <cstring>
+
+namespace supbub{
+
+  /* log2 of the initial number of slots of the hash table */
+  static const int INITIAL_BITS = 10;
+
+  /* Returns the hash of a name, computed 8 characters at a time. */
+  static inline uint64_t
+  hashName(const char* name, int64_t length){
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ uint64_t(length);
+    int64_t i = 0;
+    uint64_t word;
+    for (; i + 8 <= length; i += 8) {
+      memcpy(&word, name + i, 8);
+      h = (h ^ word) * 0xFF51AFD7ED558CCDULL;
+      h ^= h >> 32;
+    }
+    word = 0;
+    memcpy(&word, name + i, length - i);
+    h = (h ^ word) * 0xC4CEB9FE1A85EC53ULL;
+    return h ^ (h >> 29);
+  }
+
+  VertexNames::VertexNames() {
+    _offsets.push_back(0);
+    _bits = INITIAL_BITS;
+    _slots = new int64_t[int64_t(2) << _bits];
+    std::fill_n(_slots, int64_t(2) << _bits, -1);
+    _trackedBytes = 0;
+    updateTrackedMemory();
+  }
+
+  VertexNames::~VertexNames() {
+    delete[] _slots;
+    memoryChanged(MEM_GRAPH, -_trackedBytes);
+  }
+
+  int64_t
+  VertexNames::intern(const char* name, int64_t length){
+    uint64_t h = hashName(name, length);
+    int64_t mask = (int64_t(1) << _bits) - 1;
+    int64_t i = int64_t(h >> (64 - _bits));
+    while (_slots[2 * i] != -1) {
+      int64_t v = _slots[2 * i];
+      if (uint64_t(_slots[2 * i + 1]) == h && nameLength(v) == length && memcmp(_arena.data() + _offsets[v], name, length) == 0) {
+	return v;
+      }
+      i = (i + 1) & mask;
+    }
+    // new name: appended to the arena; the table is kept at most half full
+    int64_t v = size();
+    _slots[2 * i] = v;
+    _slots[2 * i + 1] = int64_t(h);
+    size_t capacity = _arena.capacity() + _offsets.capacity();
+    _arena.insert(_arena.end(), name, name + length);
+    _offsets.push_back(_arena.size());
+    if (2 * size() > (int64_t(1) << _bits)) {
+      grow();
+    }
+    else if (_arena.capacity() + _offsets.capacity() != capacity) {
+      updateTrackedMemory();
+    }
+    return v;
+  }
+
+  void
+  VertexNames::freeze(){
+    delete[] _slots;
+    _slots = nullptr;
+    _bits = 0;
+    updateTrackedMemory();
+  }
+
+  //////////////////////// private ////////////////////////
+
+  void
+  VertexNames::grow(){
+    int64_t* old = _slots;
+    int64_t oldSlots = int64_t(1) << _bits;
+    _bits++;
+    _slots = new int64_t[int64_t(2) << _bits];
+    std::fill_n(_slots, int64_t(2) << _bits, -1);
+    int64_t mask = (int64_t(1) << _bits) - 1;
+    for (int64_t j = 0; j < oldSlots; ++j) {
+      if (old[2 * j] != -1) {
+	int64_t i = int64_t(uint64_t(old[2 * j + 1]) >> (64 - _bits));
+	while (_slots[2 * i] != -1) {
+	  i = (i + 1) & mask;
+	}
+	_slots[2 * i] = old[2 * j];
+	_slots[2 * i + 1] = old[2 * j + 1];
+      }
+    }
+    delete[] old;
+    updateTrackedMemory();
+  }
+
+  void
+  VertexNames::updateTrackedMemory(){
+    int64_t bytes = _arena.capacity() + sizeof(int64_t) * _offsets.capacity();
+    if (_slots != nullptr) {
+      bytes += sizeof(int64_t) * (int64_t(2) << _bits);
+    }
+    memoryChanged(MEM_GRAPH, bytes - _trackedBytes);
+    _trackedBytes = bytes;
+  }
+
+} // end namespace
@@ -0,0 +1,97 @@
+/**
+    Superbubbles
+    Copyright (C) 2016 Ritu Kundu, Fatima Vayani, Manal Mohamed, Solon P. Pissis
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/** Defines the class VertexNames.
+ * It gives dense ids to the vertices of an input whose vertices are named (e.g. unitig or read identifiers), and writes the names back.
+ */
+
+#ifndef VERTEX_NAMES_HPP
+#define VERTEX_NAMES_HPP
+
+#include "globalDefs.hpp"
+#include "MemoryStats.hpp"
+
+namespace supbub{
+
+  /** Class VertexNames
+   * The names are interned while the input is read: the distinct names are stored one after the other in one array of characters (the arena, without separators),
+   * and vertex v is the v-th distinct name (order of first appearance), found at offsets[v] up to offsets[v+1] in the arena.
+   * Names are looked up in an open-addressing hash table (linear probing, at most half full) whose slots hold the id and the hash of a name: the names are compared only when the hashes are equal, and the table grows without hashing the names again.
+   * The table is released by freeze() once the input is read; the arena and the offsets stay to write the names (no allocation per name written).
+   *
+   * This class provides for the following:
+   *  - Giving the id of a name (while reading).
+   *  - Giving the name of an id, or writing it to a stream.
+   */
+
+  class VertexNames{
+
+  public:
+
+    /** Constructor (no name yet) */
+    VertexNames();
+
+    /** Destructor */
+    ~VertexNames();
+
+    /** Gives the id of the given name, which is new (the number of distinct names seen before it) if the name has not been seen before.
+     * Must not be called after freeze().
+     * @param name pointer to the characters of the name (not necessarily null-terminated).
+     * @param length number of characters of the name.
+     */
+    int64_t intern(const char* name, int64_t length);
+
+    /** Releases the hash table: intern() may not be called any more. */
+    void freeze();
+
+    /** Gives the number of distinct names. */
+    int64_t size() const { return _offsets.size() - 1; }
+
+    /** Returns a pointer to the name of the given vertex (not null-terminated). Assumes 0 <= v < size(). */
+    const char* name(int64_t v) const { return _arena.data() + _offsets[v]; }
+
+    /** Gives the number of characters of the name of the given vertex. Assumes 0 <= v < size(). */
+    int64_t nameLength(int64_t v) const { return _offsets[v + 1] - _offsets[v]; }
+
+    /** Writes the name of the given vertex to the given stream. Assumes 0 <= v < size(). */
+    void write(std::ostream& out, int64_t v) const { out.write(name(v), nameLength(v)); }
+
+    //////////////////////// private ////////////////////////
+  private:
+
+    /** names, one after the other */
+    std::vector<char> _arena;
+
+    /** start of the name of each id in the arena, followed by the end of the last one */
+    std::vector<int64_t> _offsets;
+
+    /** hash table: slot i holds an id in _slots[2i] (-1 if empty) and the hash of its name in _slots[2i+1] */
+    int64_t* _slots;
+
+    /** log2 of the number of slots */
+    int _bits;
+
+    /** bytes accounted to MEM_GRAPH */
+    int64_t _trackedBytes;
+
+    /** Doubles the number of slots and inserts the ids again (from the hashes kept in the slots). */
+    void grow();
+
+    /** Accounts the memory currently held. */
+    void updateTrackedMemory();
+  };
+
+} // end namespace
+#endif
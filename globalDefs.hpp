@@ -23,6 +23,8 @@
 #include <stdio.h>
 #include <iterator>
 #include <list>
+#include <vector>
+#include <algorithm>
 #include <stack>
 #include <string>
 #include <iostream>
@@ -30,6 +32,17 @@
 
 namespace supbub{
 #define DEBUG
+
+/* Policy of the accessors of Graph, Subgraph and DAG (ids, degrees, orders):
+ *  - checked build (NDEBUG not defined, make DEBUG=1): ids are range-checked, invalid ones are logged and counted.
+ *  - unchecked build (release, -DNDEBUG): accessors are inlined without any check.
+ * In both, diagnostics of normal operation are only counted (see countDiagnostic()).
+ */
+#ifdef NDEBUG
+#define SUPBUB_CHECKED 0
+#else
+#define SUPBUB_CHECKED 1
+#endif
 #ifdef _USE_64
   //typedef int64_t INT;
 #endif
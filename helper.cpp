@@ -17,12 +17,37 @@
 
 #include "helperDefs.hpp"
 
+#include <atomic>
+
 namespace supbub{
 
   static struct option long_options[] =
     {
       { "input-file",              required_argument, NULL, 'i' },
       { "output-file",             required_argument, NULL, 'o' },
+      { "relabel",                 no_argument,       NULL, 'r' },
+      { "block-rmq",               no_argument,       NULL, 'b' },
+      { "memory-limit",            required_argument, NULL, 'm' },
+      { "temp-dir",                required_argument, NULL, 'T' },
+      { "stats",                   no_argument,       NULL, 's' },
+      { "estimate-memory",         no_argument,       NULL, 'e' },
+      { "sizes",                   no_argument,       NULL, 'z' },
+      { "interior-file",           required_argument, NULL, 'I' },
+      { "tree-file",               required_argument, NULL, 't' },
+      { "tree-parentheses",        no_argument,       NULL, 'P' },
+      { "threads",                 required_argument, NULL, 'j' },
+      { "unordered",               no_argument,       NULL, 'u' },
+      { "index-file",              required_argument, NULL, 'x' },
+      { "verify",                  no_argument,       NULL, 'V' },
+      { "drop-self-loops",         no_argument,       NULL, 'L' },
+      { "sparse-ids",              no_argument,       NULL, 'S' },
+      { "names",                   no_argument,       NULL, 'N' },
+      { "serve",                   required_argument, NULL, 'D' },
+      { "publish-graph",           required_argument, NULL, 'G' },
+      { "attach-graph",            required_argument, NULL, 'A' },
+      { "seeds",                   required_argument, NULL, 'R' },
+      { "radius",                  required_argument, NULL, 'k' },
+      { "max-region",              required_argument, NULL, 'K' },
       { "help",                    no_argument,       NULL, 'h' },
       { NULL,                      0,                 NULL, 0   }
     };
@@ -35,17 +60,41 @@ namespace supbub{
     int opt;
     int val;
     char* ep;
-    int args;  
+    int args = 0;  
     /* initialisation */
     flags -> input_filename = NULL;
     flags -> output_filename = NULL;
-    while ((opt = getopt_long(argc, argv, "i:o:h", long_options, &oi)) != - 1) {
+    flags -> relabel = false;
+    flags -> blockRmq = false;
+    flags -> memory_limit = 0;
+    flags -> temp_dir = NULL;
+    flags -> stats = false;
+    flags -> estimate_memory = false;
+    flags -> sizes = false;
+    flags -> interior_filename = NULL;
+    flags -> tree_filename = NULL;
+    flags -> tree_parentheses = false;
+    flags -> threads = 1;
+    flags -> unordered = false;
+    flags -> index_filename = NULL;
+    flags -> verify = false;
+    flags -> drop_self_loops = false;
+    flags -> sparse_ids = false;
+    flags -> names = false;
+    flags -> serve_socket = NULL;
+    flags -> publish_graph = NULL;
+    flags -> attach_graph = NULL;
+    flags -> seeds = NULL;
+    flags -> radius = 10;
+    flags -> max_region = 0;
+    while ((opt = getopt_long(argc, argv, "i:o:rbm:T:sezI:t:Pj:ux:VLSND:G:A:R:k:K:h", long_options, &oi)) != - 1) {
       switch (opt) {
       case 'i':
 	{
 	  std::string inFile(optarg);
 	  flags->input_filename = new char[inFile.size() + 1];
 	  inFile.copy(flags->input_filename, inFile.size());
+	  flags->input_filename[inFile.size()] = '\0';
 	  args ++;
 	  break;
 	}
@@ -55,15 +104,187 @@ namespace supbub{
 	  std::string outFile(optarg);
 	  flags->output_filename = new char[outFile.size() + 1];
 	  outFile.copy(flags->output_filename, outFile.size());
+	  flags->output_filename[outFile.size()] = '\0';
 	  args ++;
 	  break;
 	}
 
+      case 'r':
+	flags->relabel = true;
+	break;
+
+      case 'b':
+	flags->blockRmq = true;
+	break;
+
+      case 'm':
+	flags->memory_limit = parseSize(optarg);
+	if (flags->memory_limit <= 0) {
+	  fprintf(stderr, "Invalid memory limit: %s\n", optarg);
+	  return (0);
+	}
+	break;
+
+      case 'T':
+	{
+	  std::string tempDir(optarg);
+	  flags->temp_dir = new char[tempDir.size() + 1];
+	  tempDir.copy(flags->temp_dir, tempDir.size());
+	  flags->temp_dir[tempDir.size()] = '\0';
+	  break;
+	}
+
+      case 's':
+	flags->stats = true;
+	break;
+
+      case 'e':
+	flags->estimate_memory = true;
+	break;
+
+      case 'z':
+	flags->sizes = true;
+	break;
+
+      case 'I':
+	{
+	  std::string interiorFile(optarg);
+	  flags->interior_filename = new char[interiorFile.size() + 1];
+	  interiorFile.copy(flags->interior_filename, interiorFile.size());
+	  flags->interior_filename[interiorFile.size()] = '\0';
+	  break;
+	}
+
+      case 't':
+	{
+	  std::string treeFile(optarg);
+	  flags->tree_filename = new char[treeFile.size() + 1];
+	  treeFile.copy(flags->tree_filename, treeFile.size());
+	  flags->tree_filename[treeFile.size()] = '\0';
+	  break;
+	}
+
+      case 'P':
+	flags->tree_parentheses = true;
+	break;
+
+      case 'j':
+	val = strtol(optarg, &ep, 10);
+	if (ep == optarg || *ep != '\0' || val < 1) {
+	  fprintf(stderr, "Invalid number of threads: %s\n", optarg);
+	  return (0);
+	}
+	flags->threads = val;
+	break;
+
+      case 'u':
+	flags->unordered = true;
+	break;
+
+      case 'x':
+	{
+	  std::string indexFile(optarg);
+	  flags->index_filename = new char[indexFile.size() + 1];
+	  indexFile.copy(flags->index_filename, indexFile.size());
+	  flags->index_filename[indexFile.size()] = '\0';
+	  break;
+	}
+
+      case 'V':
+	flags->verify = true;
+	break;
+
+      case 'L':
+	flags->drop_self_loops = true;
+	break;
+
+      case 'S':
+	flags->sparse_ids = true;
+	break;
+
+      case 'N':
+	flags->names = true;
+	break;
+
+      case 'D':
+	{
+	  std::string socketPath(optarg);
+	  flags->serve_socket = new char[socketPath.size() + 1];
+	  socketPath.copy(flags->serve_socket, socketPath.size());
+	  flags->serve_socket[socketPath.size()] = '\0';
+	  break;
+	}
+
+      case 'G':
+	{
+	  std::string segment(optarg);
+	  flags->publish_graph = new char[segment.size() + 1];
+	  segment.copy(flags->publish_graph, segment.size());
+	  flags->publish_graph[segment.size()] = '\0';
+	  break;
+	}
+
+      case 'A':
+	{
+	  std::string segment(optarg);
+	  flags->attach_graph = new char[segment.size() + 1];
+	  segment.copy(flags->attach_graph, segment.size());
+	  flags->attach_graph[segment.size()] = '\0';
+	  args ++; // (instead of the input file)
+	  break;
+	}
+
+      case 'R':
+	{
+	  std::string seeds(optarg);
+	  flags->seeds = new char[seeds.size() + 1];
+	  seeds.copy(flags->seeds, seeds.size());
+	  flags->seeds[seeds.size()] = '\0';
+	  break;
+	}
+
+      case 'k':
+	flags->radius = strtoll(optarg, &ep, 10);
+	if (ep == optarg || *ep != '\0' || flags->radius < 0) {
+	  fprintf(stderr, "Invalid radius: %s\n", optarg);
+	  return (0);
+	}
+	break;
+
+      case 'K':
+	flags->max_region = strtoll(optarg, &ep, 10);
+	if (ep == optarg || *ep != '\0' || flags->max_region < 1) {
+	  fprintf(stderr, "Invalid largest number of vertices of the region: %s\n", optarg);
+	  return (0);
+	}
+	break;
+
       case 'h':
 	return (0);
       }
     }
-    if ( args < 2 ){
+    if (flags->sparse_ids && flags->names) {
+      fprintf(stderr, "Options --sparse-ids and --names cannot be given together\n");
+      return (0);
+    }
+    if (flags->serve_socket != NULL && (flags->sparse_ids || flags->names)) {
+      fprintf(stderr, "Option --serve needs the numbered input format (not --sparse-ids or --names)\n");
+      return (0);
+    }
+    if (flags->attach_graph != NULL && (flags->input_filename != NULL || flags->publish_graph != NULL || flags->estimate_memory || flags->sparse_ids || flags->names)) {
+      fprintf(stderr, "Option --attach-graph replaces the input file (no --input-file, --publish-graph, --estimate-memory, --sparse-ids or --names)\n");
+      return (0);
+    }
+    if (flags->publish_graph != NULL && flags->names) {
+      fprintf(stderr, "Option --publish-graph does not keep the names of the vertices (--names)\n");
+      return (0);
+    }
+    if (flags->seeds != NULL && (flags->names || flags->verify || flags->serve_socket != NULL)) {
+      fprintf(stderr, "Option --seeds cannot be given with --names, --verify or --serve\n");
+      return (0);
+    }
+    bool hasInput = (flags->input_filename != NULL || flags->attach_graph != NULL);
+    if ( args < 2 && !((flags->estimate_memory || flags->serve_socket != NULL || flags->publish_graph != NULL) && hasInput) ){ // output file is not needed for an estimate, when serving, or when only publishing the graph
       return (0);
     }
     else{
@@ -78,8 +299,59 @@ namespace supbub{
   usage(void){
     fprintf ( stdout, " Usage: supbub <options>\n" );
     fprintf ( stdout, " Standard (Mandatory):\n" );
-    fprintf ( stdout, "  -i, --input-file          <str>     Input file  name.\n" );
+    fprintf ( stdout, "  -i, --input-file          <str>     Input file  name (- for stdin; plain, gzip or zstd).\n" );
     fprintf ( stdout, "  -o, --output-file         <str>     Output filename.\n" );
+    fprintf ( stdout, " Optional:\n" );
+    fprintf ( stdout, "  -r, --relabel                       Renumber vertices of each DAG in topological order before detection.\n" );
+    fprintf ( stdout, "  -b, --block-rmq                     Answer range queries with a block sparse table (faster, more memory).\n" );
+    fprintf ( stdout, "  -m, --memory-limit        <size>    Keep memory under size (e.g. 200G): partitions are spilled to disk if needed.\n" );
+    fprintf ( stdout, "  -T, --temp-dir            <str>     Directory for temporary files (default $TMPDIR or /tmp).\n" );
+    fprintf ( stdout, "  -s, --stats                         Print the time and the memory (per component) of each stage on stderr.\n" );
+    fprintf ( stdout, "  -e, --estimate-memory               Only estimate the memory needed, from the numbers of vertices and edges.\n" );
+    fprintf ( stdout, "  -z, --sizes                         Write the number of vertices and edges of each superbubble.\n" );
+    fprintf ( stdout, "  -I, --interior-file       <str>     Write the vertices of each superbubble in this file.\n" );
+    fprintf ( stdout, "  -t, --tree-file           <str>     Write the tree of nested superbubbles in this file (parent of each superbubble).\n" );
+    fprintf ( stdout, "  -P, --tree-parentheses              Write the tree as balanced parentheses instead (with -t).\n" );
+    fprintf ( stdout, "  -j, --threads             <int>     Number of threads processing subgraphs (default 1).\n" );
+    fprintf ( stdout, "  -u, --unordered                     Write the superbubbles in the order found instead of sorted by entrance (faster).\n" );
+    fprintf ( stdout, "  -x, --index-file          <str>     Write a binary index of the superbubbles in this file (lookups by entrance or exit).\n" );
+    fprintf ( stdout, "  -V, --verify                        Check the superbubbles found against a brute-force search (small graphs only).\n" );
+    fprintf ( stdout, "  -L, --drop-self-loops               Remove the edges from a vertex to itself (duplicate edges are always collapsed).\n" );
+    fprintf ( stdout, "  -S, --sparse-ids                    Input without the number of vertices: any non-negative ids, compacted while reading.\n" );
+    fprintf ( stdout, "  -N, --names                         Input without the number of vertices, whose vertices are names (no whitespace).\n" );
+    fprintf ( stdout, "  -D, --serve               <str>     Keep the graph in memory and answer requests (edits included) on this unix socket.\n" );
+    fprintf ( stdout, "  -G, --publish-graph       <str>     Publish the graph read in this POSIX shared memory segment (then stop, unless -o is given).\n" );
+    fprintf ( stdout, "  -A, --attach-graph        <str>     Take the graph from this shared memory segment instead of an input file (read-only, not copied).\n" );
+    fprintf ( stdout, "  -R, --seeds               <list>    Only find the superbubbles of the region around these vertices (ids separated by commas).\n" );
+    fprintf ( stdout, "  -k, --radius              <int>     With -R, largest number of edges from a seed to a vertex of the region (default 10).\n" );
+    fprintf ( stdout, "  -K, --max-region          <int>     With -R, largest number of vertices of the region (default: no bound).\n" );
+  }
+
+  /** Parses a size given in bytes with an optional suffix K, M, G or T (powers of 1024).
+   * @return the size in bytes, or -1 if s is not a valid size.
+   */
+  int64_t
+  parseSize(const char* s){
+    char* end;
+    double value = strtod(s, &end);
+    if (end == s || value < 0) {
+      return -1;
+    }
+    switch (*end) {
+    case 'T': case 't':
+      value *= 1024;
+    case 'G': case 'g':
+      value *= 1024;
+    case 'M': case 'm':
+      value *= 1024;
+    case 'K': case 'k':
+      value *= 1024;
+      ++end;
+    }
+    if (*end != '\0') {
+      return -1;
+    }
+    return (int64_t)value;
   }
 
   double 
@@ -98,4 +370,25 @@ namespace supbub{
   void log(std::string s, int64_t x, int64_t y){
     std::cerr << s << x << " " << y << std::endl;
   }
+
+  /* counters of the diagnostics */
+  static std::atomic<int64_t> diagnostics[DIAG_NUM_DIAGNOSTICS];
+
+  void countDiagnostic(Diagnostic d){
+    diagnostics[d].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  int64_t diagnosticCount(Diagnostic d){
+    return diagnostics[d].load();
+  }
+
+  void printDiagnostics(FILE* out){
+    fprintf(out, "Invalid ids given to accessors: %ld\n", (long)diagnosticCount(DIAG_INVALID_ID));
+    fprintf(out, "Invalid exit candidates: %ld\n", (long)diagnosticCount(DIAG_INVALID_EXIT));
+  }
+
+  void invalidId(std::string s, int64_t x){
+    log(s, x);
+    countDiagnostic(DIAG_INVALID_ID);
+  }
 } // end namespace
@@ -18,6 +18,7 @@
 
 #include <sys/time.h>
 #include <getopt.h>
+#include <cstdlib>
 
 
 #include "globalDefs.hpp"
@@ -26,17 +27,55 @@ namespace supbub{
 struct InputFlags{
   char* input_filename;
   char* output_filename;
+  bool relabel; // renumber DAG vertices in topological order before detection
+  bool blockRmq; // use BlockRMQ instead of the succinct rmq
+  int64_t memory_limit; // in bytes (0 if not given)
+  char* temp_dir; // directory for temporary files (NULL if not given)
+  bool stats; // print time and memory of each stage
+  bool estimate_memory; // only estimate the memory needed
+  bool sizes; // write the number of vertices and edges of each superbubble
+  char* interior_filename; // file for the vertices of each superbubble (NULL if not given)
+  char* tree_filename; // file for the tree of superbubbles (NULL if not given)
+  bool tree_parentheses; // write the tree as balanced parentheses instead of a parent array
+  int threads; // number of threads processing subgraphs
+  bool unordered; // write the superbubbles in the order found instead of sorted by entrance
+  char* index_filename; // binary index of the superbubbles (NULL if not given)
+  bool verify; // check the superbubbles found against a brute-force search
+  bool drop_self_loops; // remove the edges v-v of the input
+  bool sparse_ids; // the input has no vertex count and any non-negative ids, compacted while reading
+  bool names; // the vertices of the input are names (no vertex count), given ids in order of first appearance
+  char* serve_socket; // unix socket on which requests are answered (NULL if not serving)
+  char* publish_graph; // shared memory segment in which the graph is published (NULL if not given)
+  char* attach_graph; // shared memory segment from which the graph is taken instead of the input file (NULL if not given)
+  char* seeds; // vertices around which the region is extracted, separated by commas (NULL for the whole graph)
+  int64_t radius; // largest number of edges from a seed to a vertex of the region
+  int64_t max_region; // largest number of vertices of the region (0 if not given)
 
 };
 
 void usage (void);
 int decodeFlags(int argc, char* argv [], struct InputFlags* flags);
 double gettime(void);
+int64_t parseSize(const char* s);
 
 void log(std::string s, int64_t x);
 
 void log(std::string s, int64_t x, int64_t y);
 
+/** diagnostics counted (instead of written to stderr) */
+enum Diagnostic {
+  DIAG_INVALID_ID,        // invalid id given to an accessor (checked builds only)
+  DIAG_INVALID_EXIT,      // exit candidate found invalid while validating a superbubble
+  DIAG_NUM_DIAGNOSTICS
+};
+
+void countDiagnostic(Diagnostic d);
+int64_t diagnosticCount(Diagnostic d);
+void printDiagnostics(FILE* out);
+
+/** Reports an invalid id given to an accessor (checked builds): logs it and counts it. */
+void invalidId(std::string s, int64_t x);
+
 } // end namespace
 
 #endif
@@ -17,11 +17,23 @@
  */
 
 #include <fstream>
+#include <sstream>
+#include <algorithm>
 #include <cstdlib>
 
 #include "globalDefs.hpp"
 #include "Graph.hpp"
 #include "DetectSuperBubble.hpp"
+#include "MemoryStats.hpp"
+#include "SuperBubbleTree.hpp"
+#include "ResultIndex.hpp"
+#include "Verify.hpp"
+#include "VertexIds.hpp"
+#include "VertexNames.hpp"
+#include "InputStream.hpp"
+#include "Server.hpp"
+#include "SharedGraph.hpp"
+#include "Region.hpp"
 #include "helperDefs.hpp"
 
 
@@ -35,24 +47,209 @@ int main(int argc, char **argv){
     usage();
     return (1);
   }
-  /* Read the input file in memory */
-  std::ifstream infile(flags.input_filename);
-  if(!infile.is_open()){
-    fprintf(stderr, "Cannot open input file \n" );
+  /* Read the input file in memory (plain, gzip or zstd; "-" is the standard input), decompressed by a thread while it is parsed */
+  InputStream input;
+  if(flags.attach_graph == NULL && !input.open(flags.input_filename)){
+    fprintf(stderr, "Cannot open input file: %s \n", input.error());
     return 1;
   }
-  // First line of the file contains number odf vertices
-  int64_t numVertices;
-  infile >> numVertices;
-  Graph graph(numVertices);
+  std::istream infile(&input);
+  // First line of the file contains number odf vertices (unless ids are sparse, or vertices are named: they are then discovered while reading)
+  int64_t numVertices = 0;
+  VertexIds* vertexIds = nullptr;
+  VertexNames* vertexNames = nullptr;
+  if (flags.sparse_ids) {
+    vertexIds = new VertexIds();
+  }
+  else if (flags.names) {
+    vertexNames = new VertexNames();
+  }
+  else if (flags.attach_graph == NULL) {
+    infile >> numVertices;
+  }
 
   // File contains edges such that
   //  - new line as separator between edges
   //  - space/tab a separator between vertices of an edge
   int64_t u, v;
-  while (infile >> u >> v) {
-    // add egde in the graph
-    graph.addEdge(u, v);
+  std::string uName, vName; // (names are read into the same buffers from one edge to the next)
+  if (flags.estimate_memory) { // dry run: only count the edges
+    int64_t numEdges = 0;
+    if (vertexNames != nullptr) {
+      while (infile >> uName >> vName) {
+	vertexNames->intern(uName.data(), uName.size());
+	vertexNames->intern(vName.data(), vName.size());
+	numEdges++;
+      }
+      numVertices = vertexNames->size();
+      delete vertexNames;
+    }
+    else {
+      while (infile >> u >> v) {
+	if (vertexIds != nullptr) {
+	  vertexIds->intern(u);
+	  vertexIds->intern(v);
+	}
+	numEdges++;
+      }
+    }
+    if (vertexIds != nullptr) {
+      numVertices = vertexIds->size();
+      delete vertexIds;
+    }
+    if (input.error() != nullptr) {
+      fprintf(stderr, "Cannot read input file: %s \n", input.error());
+      return 1;
+    }
+    fprintf(stdout, "Vertices: %ld\nEdges: %ld\n", (long)numVertices, (long)numEdges);
+    printMemoryEstimate(stdout, numVertices, numEdges, flags.blockRmq, flags.relabel);
+    delete[] flags.input_filename;
+    delete[] flags.output_filename;
+    delete[] flags.temp_dir;
+    delete[] flags.interior_filename;
+    delete[] flags.tree_filename;
+    delete[] flags.index_filename;
+    delete[] flags.serve_socket;
+    delete[] flags.publish_graph;
+    delete[] flags.seeds;
+    return 0;
+  }
+  Graph* graph;
+  SharedGraph* sharedGraph = nullptr;
+  if (flags.attach_graph != NULL) {
+    // graph published by another process (finalized already), mapped read-only instead of read
+    sharedGraph = SharedGraph::attach(flags.attach_graph);
+    if (sharedGraph == nullptr) {
+      return 1;
+    }
+    numVertices = sharedGraph->numVertices();
+    graph = sharedGraph;
+  }
+  else if (vertexIds != nullptr) {
+    // edges with provisional ids (in order of first appearance), renumbered once all ids are known
+    std::vector<int64_t> tails;
+    std::vector<int64_t> heads;
+    while (infile >> u >> v) {
+      if (u < 0 || v < 0) {
+	fprintf(stderr, "Invalid edge %ld %ld: ids are non-negative \n", (long)u, (long)v);
+	return 1;
+      }
+      tails.push_back(vertexIds->intern(u));
+      heads.push_back(vertexIds->intern(v));
+    }
+    vertexIds->compact(tails, heads, flags.threads);
+    numVertices = vertexIds->size();
+    graph = new Graph(numVertices);
+    graph->addEdges(tails, heads);
+  }
+  else if (vertexNames != nullptr) {
+    // ids are given in order of first appearance: they are dense already
+    std::vector<int64_t> tails;
+    std::vector<int64_t> heads;
+    while (infile >> uName >> vName) {
+      tails.push_back(vertexNames->intern(uName.data(), uName.size()));
+      heads.push_back(vertexNames->intern(vName.data(), vName.size()));
+    }
+    vertexNames->freeze();
+    numVertices = vertexNames->size();
+    graph = new Graph(numVertices);
+    graph->addEdges(tails, heads);
+  }
+  else {
+    graph = new Graph(numVertices);
+    while (infile >> u >> v) {
+      if (u < 0 || u >= numVertices || v < 0 || v >= numVertices) {
+	fprintf(stderr, "Invalid edge %ld %ld: vertices are from 0 to %ld \n", (long)u, (long)v, (long)(numVertices - 1));
+	return 1;
+      }
+      // add egde in the graph
+      graph->addEdge(u, v);
+    }
+  }
+  if (input.error() != nullptr) {
+    fprintf(stderr, "Cannot read input file: %s \n", input.error());
+    return 1;
+  }
+  // vertices are written in the results as given in the input (name, original id or id)
+  const int64_t* originalIds = (vertexIds != nullptr) ? vertexIds->originals() : nullptr;
+  if (sharedGraph != nullptr) {
+    originalIds = sharedGraph->originalIds(); // (kept mapped until the results are written)
+  }
+  auto writeVertex = [originalIds, vertexNames](std::ostream& out, int64_t v) {
+    if (vertexNames != nullptr) {
+      vertexNames->write(out, v);
+    }
+    else {
+      out << ((originalIds == nullptr) ? v : originalIds[v]);
+    }
+  };
+  // each distinct edge once (and no self-loop if asked)
+  int64_t removedEdges = (sharedGraph != nullptr) ? 0 : graph->finalizeUnique(flags.threads, flags.drop_self_loops);
+  int64_t numEdges = graph->numEdges();
+  markStage("read input");
+
+  /* Publish the graph for other processes (--attach-graph) */
+  if (flags.publish_graph != NULL) {
+    if (!SharedGraph::publish(flags.publish_graph, *graph, originalIds)) {
+      return 1;
+    }
+    markStage("publish graph");
+    if (flags.output_filename == NULL && flags.serve_socket == NULL) { // only published
+      fprintf(stdout, "Vertices: %ld\nEdges: %ld\n", (long)numVertices, (long)numEdges);
+      delete graph;
+      delete vertexIds;
+      delete[] flags.input_filename;
+      delete[] flags.temp_dir;
+      delete[] flags.interior_filename;
+      delete[] flags.tree_filename;
+      delete[] flags.index_filename;
+      delete[] flags.publish_graph;
+      delete[] flags.seeds;
+      return 0;
+    }
+  }
+
+  /* Options of the detection */
+  DetectSuperBubble::Options options;
+  options.relabel = flags.relabel;
+  options.blockRmq = flags.blockRmq;
+  options.interiorSizes = flags.sizes;
+  options.interiorVertices = nullptr;
+  options.originalIds = originalIds;
+  options.vertexNames = vertexNames;
+  options.hierarchy = (flags.tree_filename != NULL);
+  options.numThreads = flags.threads;
+  options.unordered = flags.unordered;
+
+  /* Resident mode: the graph and its superbubbles are kept in memory and queried (and edited) over a socket */
+  if (flags.serve_socket != NULL) {
+    if (originalIds != nullptr) {
+      fprintf(stderr, "Option --serve needs the numbered input format (the published graph has sparse ids) \n");
+      return 1;
+    }
+    Server server(graph, options, flags.drop_self_loops); // (owns the graph)
+    markStage("find (resident)");
+    bool served = server.run(flags.serve_socket);
+    if (flags.stats) {
+      printMemoryReport(stderr);
+    }
+    delete[] flags.input_filename;
+    delete[] flags.output_filename;
+    delete[] flags.temp_dir;
+    delete[] flags.interior_filename;
+    delete[] flags.tree_filename;
+    delete[] flags.index_filename;
+    delete[] flags.serve_socket;
+    delete[] flags.publish_graph;
+    delete[] flags.attach_graph;
+    return served ? 0 : 1;
+  }
+
+  /* References for --verify (while the graph is in memory) */
+  VerifyReference verifyReference;
+  if (flags.verify) {
+    prepareVerification(*graph, verifyReference);
+    markStage("verify (references)");
   }
 
 
@@ -61,8 +258,91 @@ int main(int argc, char **argv){
 
   /* Find superbubbles */
   double start = gettime();
-  DetectSuperBubble dsb;
-  dsb.find(graph, superBubblesList); 
+  std::ofstream interiorFile;
+  if (flags.interior_filename != NULL) {
+    interiorFile.open(flags.interior_filename);
+    if(!interiorFile.is_open()){
+      fprintf(stderr, "Cannot open interior file \n" );
+      return 1;
+    }
+    options.interiorVertices = &interiorFile;
+  }
+  /* Region around the seeds (--seeds): only its superbubbles are found */
+  Region* region = nullptr;
+  std::vector<int64_t> regionIds; // ids written for the vertices of the region graph
+  if (flags.seeds != NULL) {
+    std::vector<int64_t> seeds;
+    std::istringstream seedList(flags.seeds);
+    std::string seed;
+    while (std::getline(seedList, seed, ',')) {
+      char* end;
+      int64_t v = strtoll(seed.c_str(), &end, 10);
+      bool valid = (end != seed.c_str() && *end == '\0');
+      if (valid && originalIds != nullptr) { // an original id: its rank among the original ids (they are sorted)
+	const int64_t* found = std::lower_bound(originalIds, originalIds + numVertices, v);
+	valid = (found != originalIds + numVertices && *found == v);
+	v = found - originalIds;
+      }
+      if (!valid || v < 0 || v >= numVertices) {
+	fprintf(stderr, "Invalid seed: %s \n", seed.c_str());
+	return 1;
+      }
+      seeds.push_back(v);
+    }
+    region = new Region(*graph, seeds, flags.radius, flags.max_region);
+    regionIds.assign(region->globalIds(), region->globalIds() + region->numVertices() + 1);
+    for (int64_t l = 0; l < region->numVertices() && originalIds != nullptr; ++l) {
+      regionIds[l] = originalIds[regionIds[l]];
+    }
+    options.originalIds = regionIds.data();
+  }
+  DetectSuperBubble dsb(options);
+
+  // Peak of find() when all vertices are in one scc (the largest DAG then has twice the vertices of the whole graph)
+  MemoryEstimate estimate;
+  estimateMemory(numVertices, numEdges, numVertices, numEdges, flags.blockRmq, flags.relabel, estimate);
+  if (region != nullptr) { // (the region is small: it is processed in memory)
+    region->find(dsb, superBubblesList);
+    if (sharedGraph == nullptr) {
+      delete graph;
+    }
+  }
+  else if (flags.memory_limit > 0 && estimate.total > flags.memory_limit) {
+    // Out-of-core: spill the subgraphs, release the graph, then process subgraphs one at a time
+    const char* tempDir = flags.temp_dir;
+    if (tempDir == NULL) {
+      tempDir = getenv("TMPDIR");
+    }
+    PartitionSpill spill;
+    if (!spill.open((tempDir != NULL) ? tempDir : "/tmp")) {
+      fprintf(stderr, "Cannot create temporary file \n" );
+      return 1;
+    }
+    if (!dsb.partitionToDisk(*graph, spill)) {
+      fprintf(stderr, "Cannot write temporary file \n" );
+      return 1;
+    }
+    if (sharedGraph == nullptr) {
+      delete graph;
+      graph = nullptr;
+    }
+    for (int64_t sg = 0; sg < spill.numSubgraphs(); ++sg) {
+      int64_t bytes = estimateSubgraphBytes(spill.numVertices(sg), spill.numEdges(sg), flags.blockRmq, flags.relabel);
+      if (bytes > flags.memory_limit) {
+	fprintf(stderr, "Warning: subgraph %ld needs about %ld bytes, more than the memory limit \n", (long)sg, (long)bytes);
+      }
+    }
+    if (!dsb.findFromDisk(spill, superBubblesList)) {
+      fprintf(stderr, "Cannot read temporary file \n" );
+      return 1;
+    }
+  }
+  else {
+    dsb.find(*graph, superBubblesList);
+    if (sharedGraph == nullptr) {
+      delete graph;
+    }
+  }
   double end = gettime();
 
   /* Write output */
@@ -73,17 +353,72 @@ int main(int argc, char **argv){
   }
   
   outfile <<  "Vertices: " << numVertices << "\n";
-  outfile << "Edges: "<< graph.numEdges() << "\n";
+  outfile << "Edges: "<< numEdges << "\n";
+  if (region != nullptr) {
+    outfile << "Region: " << region->numVertices() << " vertices, " << region->numEdges() << " edges, "
+	    << region->numComplete() << " of " << region->numParts() << " parts complete.\n";
+  }
   outfile << "Elapsed time for processing: " << (end - start)<< " secs.\n";
   outfile << "Number of superbubbles found: " << superBubblesList.size()<< ".\n";
   DetectSuperBubble::SUPERBUBBLE_LIST::iterator i;
   for (i = superBubblesList.begin(); i != superBubblesList.end(); ++i) {
-    outfile << "<"<< (*i).entrance << "," << (*i).exit << ">\n";
+    outfile << "<";
+    writeVertex(outfile, (*i).entrance);
+    outfile << ",";
+    writeVertex(outfile, (*i).exit);
+    outfile << ">";
+    if (flags.sizes) {
+      outfile << " " << (*i).numVertices << " " << (*i).numEdges;
+    }
+    outfile << "\n";
+  }
+  outfile.close();
+  if (flags.tree_filename != NULL) {
+    std::ofstream treeFile(flags.tree_filename);
+    if(!treeFile.is_open()){
+      fprintf(stderr, "Cannot open tree file \n" );
+      return 1;
+    }
+    if (flags.tree_parentheses) {
+      writeBalancedParentheses(treeFile, superBubblesList, numVertices);
+    }
+    else {
+      writeParentArray(treeFile, superBubblesList, numVertices);
+    }
+  }
+  if (flags.index_filename != NULL) {
+    if (!ResultIndex::write(flags.index_filename, superBubblesList, numVertices, originalIds)) {
+      fprintf(stderr, "Cannot write index file \n" );
+      return 1;
+    }
+  }
+  markStage("write output");
+  if (flags.stats) {
+    printMemoryReport(stderr);
+    fprintf(stderr, "Edges removed from the input (duplicates%s): %ld\n", flags.drop_self_loops ? ", self-loops" : "", (long)removedEdges);
+    printDiagnostics(stderr);
+  }
+  int status = 0;
+  if (flags.verify) {
+    int64_t differences = verifySuperBubbles(stderr, verifyReference, superBubblesList, flags.sizes, originalIds, vertexNames);
+    status = (differences == 0) ? 0 : 2;
   }
   // clean up
+  delete region;
+  delete sharedGraph;
+  delete vertexIds;
+  delete vertexNames;
   delete[] flags.input_filename;
   delete[] flags.output_filename;
-  
+  delete[] flags.temp_dir;
+  delete[] flags.interior_filename;
+  delete[] flags.tree_filename;
+  delete[] flags.index_filename;
+  delete[] flags.serve_socket;
+  delete[] flags.publish_graph;
+  delete[] flags.attach_graph;
+  delete[] flags.seeds;
+  return status;
 }
 
 